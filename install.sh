@@ -5,7 +5,11 @@ SOURCES=$(dirname $0)
 
 mkdir -p "${PREFIX}/include/TASTE-Linux-Drivers/src"
 rm -rf "${PREFIX}/include/TASTE-Linux-Drivers/src/*"
+cp -r "${SOURCES}/src/DriverCommon" "${PREFIX}/include/TASTE-Linux-Drivers/src"
 cp -r "${SOURCES}/src/linux_ip_socket" "${PREFIX}/include/TASTE-Linux-Drivers/src"
 cp -r "${SOURCES}/src/linux_udp" "${PREFIX}/include/TASTE-Linux-Drivers/src"
 cp -r "${SOURCES}/src/linux_serial_ccsds" "${PREFIX}/include/TASTE-Linux-Drivers/src"
+cp -r "${SOURCES}/src/linux_serial_ccsds_bonded" "${PREFIX}/include/TASTE-Linux-Drivers/src"
+cp -r "${SOURCES}/src/linux_shm" "${PREFIX}/include/TASTE-Linux-Drivers/src"
+cp -r "${SOURCES}/src/linux_unix_socket" "${PREFIX}/include/TASTE-Linux-Drivers/src"
 cp -r "${SOURCES}/configurations" "${PREFIX}/include/TASTE-Linux-Drivers/configurations"
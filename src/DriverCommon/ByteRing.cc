@@ -0,0 +1,163 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ByteRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+namespace taste {
+
+ByteRing::ByteRing()
+    : m_capacity(0)
+    , m_write_position(0)
+    , m_writer_waiting(false)
+    , m_read_position(0)
+    , m_reader_waiting(false)
+{
+}
+
+ByteRing::~ByteRing()
+{
+    if(m_capacity != 0) {
+        sem_destroy(&m_space);
+        sem_destroy(&m_data);
+    }
+}
+
+void
+ByteRing::init(const size_t capacity)
+{
+    m_buffer.reset(new uint8_t[capacity]);
+    sem_init(&m_space, 0, 0);
+    sem_init(&m_data, 0, 0);
+    m_capacity = capacity;
+}
+
+size_t
+ByteRing::acquire_write(uint8_t** const region)
+{
+    // the waiting flag is set before checking again, so the consumer either sees it or the producer sees the space
+    size_t free_bytes = m_capacity - used();
+    while(free_bytes == 0) {
+        m_writer_waiting.store(true);
+        free_bytes = m_capacity - used();
+        if(free_bytes != 0) {
+            m_writer_waiting.store(false);
+            break;
+        }
+        wait(&m_space, NO_TIMEOUT);
+        free_bytes = m_capacity - used();
+    }
+
+    const size_t offset = m_write_position.load(std::memory_order_relaxed) % m_capacity;
+    *region = &m_buffer[offset];
+    return std::min(free_bytes, m_capacity - offset);
+}
+
+void
+ByteRing::commit_write(const size_t length)
+{
+    m_write_position.store(m_write_position.load(std::memory_order_relaxed) + length);
+    if(m_reader_waiting.exchange(false)) {
+        sem_post(&m_data);
+    }
+}
+
+size_t
+ByteRing::acquire_read(uint8_t** const region, const int timeout_ms)
+{
+    size_t available = used();
+    while(available == 0) {
+        m_reader_waiting.store(true);
+        available = used();
+        if(available != 0) {
+            m_reader_waiting.store(false);
+            break;
+        }
+        if(!wait(&m_data, timeout_ms)) {
+            m_reader_waiting.store(false);
+            return 0;
+        }
+        available = used();
+    }
+
+    const size_t offset = m_read_position.load(std::memory_order_relaxed) % m_capacity;
+    *region = &m_buffer[offset];
+    return std::min(available, m_capacity - offset);
+}
+
+void
+ByteRing::release_read(const size_t length)
+{
+    m_read_position.store(m_read_position.load(std::memory_order_relaxed) + length);
+    if(m_writer_waiting.exchange(false)) {
+        sem_post(&m_space);
+    }
+}
+
+size_t
+ByteRing::used() const
+{
+    return m_write_position.load() - m_read_position.load();
+}
+
+bool
+ByteRing::wait(sem_t* const semaphore, const int timeout_ms)
+{
+    if(timeout_ms == NO_TIMEOUT) {
+        while(sem_wait(semaphore) != 0) {
+            if(errno != EINTR) {
+                std::cerr << "sem_wait() returned an error: " << strerror(errno) << std::endl;
+                abort();
+            }
+        }
+        return true;
+    }
+
+    // a monotonic deadline, so setting the wall clock does not stretch or cut the wait
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += static_cast<long>(timeout_ms % 1000) * 1000000L;
+    if(deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while(sem_clockwait(semaphore, CLOCK_MONOTONIC, &deadline) != 0) {
+        if(errno == ETIMEDOUT) {
+            return false;
+        }
+        if(errno != EINTR) {
+            std::cerr << "sem_clockwait() returned an error: " << strerror(errno) << std::endl;
+            abort();
+        }
+    }
+    return true;
+}
+
+} // namespace taste
@@ -0,0 +1,138 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+/**
+ * @file     ByteRing.h
+ * @brief    Single producer, single consumer ring of bytes.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <semaphore.h>
+
+#include "CacheLine.h"
+
+namespace taste {
+
+/**
+ * @brief Bounded lock-free byte ring shared by one producer and one consumer thread.
+ *
+ * Both sides work directly on contiguous regions of the ring, so data can be read()
+ * into it and decoded from it without copying. A side which finds the ring full or empty
+ * sleeps until the other side makes progress.
+ * The ring is disabled until ByteRing::init is called.
+ */
+class ByteRing final
+{
+  public:
+    /// Timeout value, which makes ByteRing::acquire_read wait for data indefinitely
+    static constexpr int NO_TIMEOUT = -1;
+
+    /**
+     * @brief  Constructor.
+     */
+    ByteRing();
+
+    /**
+     * @brief  Destructor.
+     */
+    ~ByteRing();
+
+    ByteRing(const ByteRing&) = delete;
+    ByteRing& operator=(const ByteRing&) = delete;
+
+    /**
+     * @brief Allocate the ring.
+     *
+     * @param capacity       Size of the ring in bytes
+     */
+    void init(const size_t capacity);
+
+    /**
+     * @brief Check if the ring was initialized.
+     *
+     * @return true if the ring can be used
+     */
+    bool is_enabled() const { return m_capacity != 0; }
+
+    /**
+     * @brief Get the free region at the producer position.
+     *
+     * Called only by the producer. Blocks until at least one byte is free.
+     *
+     * @param region         Set to the start of the free region
+     *
+     * @return The size of the free region
+     */
+    size_t acquire_write(uint8_t** const region);
+
+    /**
+     * @brief Pass bytes written into the free region to the consumer.
+     *
+     * @param length         Number of written bytes, not more than returned by acquire_write
+     */
+    void commit_write(const size_t length);
+
+    /**
+     * @brief Get the region of data at the consumer position.
+     *
+     * Called only by the consumer. Blocks until at least one byte is available or timeout expires.
+     *
+     * @param region         Set to the start of the data
+     * @param timeout_ms     Maximum time to wait in milliseconds, or NO_TIMEOUT
+     *
+     * @return The size of the data region, 0 if timeout expired
+     */
+    size_t acquire_read(uint8_t** const region, const int timeout_ms);
+
+    /**
+     * @brief Return consumed bytes to the producer.
+     *
+     * @param length         Number of consumed bytes, not more than returned by acquire_read
+     */
+    void release_read(const size_t length);
+
+  private:
+    size_t used() const;
+    bool wait(sem_t* const semaphore, const int timeout_ms);
+
+    size_t m_capacity;
+    std::unique_ptr<uint8_t[]> m_buffer;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_write_position;
+    std::atomic<bool> m_writer_waiting;
+    sem_t m_space;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_read_position;
+    std::atomic<bool> m_reader_waiting;
+    sem_t m_data;
+};
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,45 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+/**
+ * @file     CacheLine.h
+ * @brief    Cache line size used to separate data used by different threads.
+ */
+
+#include <cstddef>
+
+namespace taste {
+
+/**
+ * @brief Size of the cache line on supported targets.
+ *
+ * Data written by different threads is aligned to this size, so the threads
+ * do not invalidate each other's cache lines.
+ */
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+} // namespace taste
+
+#endif
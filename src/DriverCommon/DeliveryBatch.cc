@@ -0,0 +1,146 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeliveryBatch.h"
+
+#include <cstring>
+
+extern "C"
+{
+#include <Broker.h>
+}
+
+namespace taste {
+
+namespace {
+
+// Escaper passes decoded packets to a callback without context,
+// so the decoding thread keeps track of the batch it collects
+thread_local DeliveryBatch* collecting_batch = nullptr;
+
+} // namespace
+
+DeliveryBatch::DeliveryBatch()
+    : m_bus_id()
+    , m_enabled(false)
+    , m_collecting(false)
+    , m_buffer_begin(nullptr)
+    , m_buffer_end(nullptr)
+    , m_count(0)
+    , m_storage_used(0)
+{
+}
+
+void
+DeliveryBatch::init(const enum SystemBus bus_id)
+{
+    m_bus_id = bus_id;
+    m_enabled = Broker_receive_packets != nullptr;
+    if(m_enabled) {
+        m_packets.reset(new iovec[MAX_PACKETS]);
+        m_storage.reset(new uint8_t[STORAGE_SIZE]);
+    }
+}
+
+void
+DeliveryBatch::begin(const uint8_t* const buffer, const size_t size)
+{
+    if(!m_enabled) {
+        return;
+    }
+    m_collecting = true;
+    m_buffer_begin = buffer;
+    m_buffer_end = buffer + size;
+}
+
+void
+DeliveryBatch::decode(FastEscaper& escaper, uint8_t* const data, const size_t length)
+{
+    if(!m_collecting) {
+        escaper.decode_packet(m_bus_id, data, length, Broker_receive_packet);
+        return;
+    }
+    collecting_batch = this;
+    escaper.decode_packet(m_bus_id, data, length, &DeliveryBatch::collect);
+    collecting_batch = nullptr;
+}
+
+void
+DeliveryBatch::add(uint8_t* const data, const size_t length)
+{
+    if(!m_collecting) {
+        Broker_receive_packet(m_bus_id, data, length);
+        return;
+    }
+
+    if(m_count == MAX_PACKETS) {
+        deliver();
+    }
+    if(data >= m_buffer_begin && data + length <= m_buffer_end) {
+        m_packets[m_count].iov_base = data;
+        m_packets[m_count].iov_len = length;
+        ++m_count;
+        return;
+    }
+
+    if(length > STORAGE_SIZE - m_storage_used) {
+        deliver();
+        if(length > STORAGE_SIZE) {
+            Broker_receive_packet(m_bus_id, data, length);
+            return;
+        }
+    }
+    memcpy(&m_storage[m_storage_used], data, length);
+    m_packets[m_count].iov_base = &m_storage[m_storage_used];
+    m_packets[m_count].iov_len = length;
+    ++m_count;
+    m_storage_used += length;
+}
+
+void
+DeliveryBatch::flush()
+{
+    if(!m_collecting) {
+        return;
+    }
+    deliver();
+    m_collecting = false;
+}
+
+void
+DeliveryBatch::collect(const enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    collecting_batch->add(data, length);
+}
+
+void
+DeliveryBatch::deliver()
+{
+    if(m_count != 0) {
+        Broker_receive_packets(m_bus_id, m_packets.get(), m_count);
+    }
+    m_count = 0;
+    m_storage_used = 0;
+}
+
+} // namespace taste
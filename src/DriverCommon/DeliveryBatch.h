@@ -0,0 +1,141 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DELIVERY_BATCH_H
+#define DELIVERY_BATCH_H
+
+/**
+ * @file     DeliveryBatch.h
+ * @brief    Delivery of all packets decoded from one receive buffer to the Broker at once.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <sys/uio.h>
+
+#include <system_spec.h>
+
+#include "FastEscaper.h"
+
+extern "C"
+{
+/**
+ * @brief Pass many received packets to the Broker at once.
+ *
+ * Optional function of the Broker, declared weak. Runtimes which provide it receive packets
+ * in batches, with one lock acquisition and wakeup per batch; otherwise packets are passed
+ * one by one to Broker_receive_packet. Packets are valid only until the function returns.
+ *
+ * @param bus_id         Identifier of the bus the packets were received from
+ * @param packets        Received packets, in order
+ * @param count          Number of packets
+ */
+void Broker_receive_packets(enum SystemBus bus_id, const struct iovec* const packets, const size_t count)
+        __attribute__((weak));
+}
+
+namespace taste {
+
+/**
+ * @brief Packets decoded from one receive buffer, passed to the Broker together.
+ *
+ * Packets which lie in the receive buffer, e.g. delivered by FastEscaper without copying,
+ * are referenced; other packets are copied into the batch's storage, because decoder
+ * buffers are reused for the next packet. The batch is delivered when full and at flush.
+ *
+ * If the Broker does not provide Broker_receive_packets, batching is disabled and every
+ * packet is passed to Broker_receive_packet as soon as it is decoded.
+ */
+class DeliveryBatch final
+{
+  public:
+    /**
+     * @brief  Constructor.
+     *
+     * Construct disabled batch, which needs to be initialized using DeliveryBatch::init
+     * before usage.
+     */
+    DeliveryBatch();
+
+    DeliveryBatch(const DeliveryBatch&) = delete;
+    DeliveryBatch& operator=(const DeliveryBatch&) = delete;
+
+    /**
+     * @brief Initialize the batch.
+     *
+     * @param bus_id         Bus passed to the Broker with delivered packets
+     */
+    void init(const enum SystemBus bus_id);
+
+    /**
+     * @brief Start collecting packets decoded from a receive buffer.
+     *
+     * @param buffer         Receive buffer, which stays unchanged until flush
+     * @param size           The size of the receive buffer
+     */
+    void begin(const uint8_t* const buffer, const size_t size);
+
+    /**
+     * @brief Decode received data and collect decoded packets.
+     *
+     * @param escaper        Decoder of the connection the data was received from
+     * @param data           Received data
+     * @param length         The size of the data
+     */
+    void decode(FastEscaper& escaper, uint8_t* const data, const size_t length);
+
+    /**
+     * @brief Collect a decoded packet, or deliver it at once if no batch was begun.
+     *
+     * @param data           Decoded packet
+     * @param length         The size of the packet
+     */
+    void add(uint8_t* const data, const size_t length);
+
+    /**
+     * @brief Deliver collected packets and stop collecting.
+     */
+    void flush();
+
+  private:
+    static constexpr size_t MAX_PACKETS = 256;
+    static constexpr size_t STORAGE_SIZE = 65536;
+
+    static void collect(const enum SystemBus bus_id, uint8_t* const data, const size_t length);
+    void deliver();
+
+    enum SystemBus m_bus_id;
+    bool m_enabled;
+    bool m_collecting;
+    const uint8_t* m_buffer_begin;
+    const uint8_t* m_buffer_end;
+    std::unique_ptr<iovec[]> m_packets;
+    size_t m_count;
+    std::unique_ptr<uint8_t[]> m_storage;
+    size_t m_storage_used;
+};
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,118 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DriverThread.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <pthread.h>
+
+namespace taste {
+
+void
+ThreadSettingsFromConfig(const Thread_Conf_T& configuration, ThreadSettings* const settings)
+{
+    if(configuration.exist.priority) {
+        settings->priority = static_cast<int>(configuration.priority);
+    }
+    if(configuration.exist.stack_size) {
+        settings->stack_size = static_cast<int>(configuration.stack_size);
+    }
+    if(configuration.exist.policy) {
+        switch(configuration.policy) {
+            case Thread_Policy_T_other:
+                settings->policy = SCHED_OTHER;
+                break;
+            case Thread_Policy_T_fifo:
+                settings->policy = SCHED_FIFO;
+                break;
+            case Thread_Policy_T_round_robin:
+                settings->policy = SCHED_RR;
+                break;
+            default:
+                std::cerr << "Not supported thread policy, keeping the inherited one" << std::endl;
+        }
+    }
+    if(configuration.exist.cpus) {
+        for(int i = 0; i < configuration.cpus.nCount; ++i) {
+            CPU_SET(static_cast<size_t>(configuration.cpus.arr[i]), &settings->cpus);
+        }
+    }
+}
+
+DriverThread::DriverThread(int priority, int stack_size)
+    : m_body(nullptr)
+    , m_data(nullptr)
+{
+    m_settings.priority = priority;
+    m_settings.stack_size = stack_size;
+    m_settings.policy = ThreadSettings::INHERITED_POLICY;
+    CPU_ZERO(&m_settings.cpus);
+}
+
+void
+DriverThread::configure(const ThreadSettings& settings)
+{
+    m_settings = settings;
+}
+
+void
+DriverThread::start(Body body, void* data)
+{
+    m_body = body;
+    m_data = data;
+    m_thread.reset(new Thread(m_settings.priority, m_settings.stack_size));
+    m_thread->start(&DriverThread::run, this);
+}
+
+void
+DriverThread::run(void* driver_thread)
+{
+    DriverThread* self = reinterpret_cast<DriverThread*>(driver_thread);
+    self->apply_settings();
+    self->m_body(self->m_data);
+}
+
+void
+DriverThread::apply_settings() const
+{
+    if(m_settings.policy != ThreadSettings::INHERITED_POLICY) {
+        sched_param parameters;
+        memset(&parameters, 0, sizeof(parameters));
+        // priority is meaningful only for real-time policies
+        parameters.sched_priority = m_settings.policy == SCHED_OTHER ? 0 : m_settings.priority;
+        const int result = pthread_setschedparam(pthread_self(), m_settings.policy, &parameters);
+        if(result != 0) {
+            std::cerr << "Cannot set thread scheduling policy: " << strerror(result) << std::endl;
+        }
+    }
+
+    if(CPU_COUNT(&m_settings.cpus) != 0) {
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &m_settings.cpus);
+        if(result != 0) {
+            std::cerr << "Cannot set thread CPU affinity: " << strerror(result) << std::endl;
+        }
+    }
+}
+
+} // namespace taste
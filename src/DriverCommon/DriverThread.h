@@ -0,0 +1,128 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRIVER_THREAD_H
+#define DRIVER_THREAD_H
+
+/**
+ * @file     DriverThread.h
+ * @brief    Driver thread with configurable scheduling, stack and CPU affinity.
+ */
+
+#include <memory>
+
+#include <sched.h>
+
+#include <Thread.h>
+
+#include <drivers_config.h>
+
+namespace taste {
+
+/**
+ * @brief Scheduling settings of a driver thread.
+ */
+struct ThreadSettings
+{
+    static constexpr int INHERITED_POLICY = -1;
+
+    int priority;   ///< Priority passed to taste::Thread, and to the policy if it is set
+    int stack_size; ///< Stack size in bytes
+    int policy;     ///< SCHED_OTHER, SCHED_FIFO, SCHED_RR or INHERITED_POLICY
+    cpu_set_t cpus; ///< CPUs the thread may run on, empty set allows all
+};
+
+/**
+ * @brief Update thread settings with the fields present in the device configuration.
+ *
+ * Fields absent from the configuration keep their values, e.g. the driver defaults.
+ *
+ * @param configuration  Thread configuration from the device configuration
+ * @param settings       Settings to update
+ */
+void ThreadSettingsFromConfig(const Thread_Conf_T& configuration, ThreadSettings* const settings);
+
+/**
+ * @brief Thread of a driver, which applies its settings before running the body.
+ *
+ * The underlying taste::Thread is created by DriverThread::start, so the stack size
+ * and priority may be changed after construction, e.g. from the device configuration.
+ * Scheduling policy and affinity are set by the thread itself before it calls the body;
+ * if they cannot be set, e.g. without CAP_SYS_NICE, an error is reported and the thread
+ * runs with the inherited settings.
+ */
+class DriverThread final
+{
+  public:
+    /**
+     * @brief Function run by the thread.
+     *
+     * @param data           Data passed to DriverThread::start
+     */
+    typedef void (*Body)(void* data);
+
+    /**
+     * @brief  Constructor.
+     *
+     * @param priority       Default priority of the thread
+     * @param stack_size     Default stack size of the thread
+     */
+    DriverThread(int priority, int stack_size);
+
+    DriverThread(const DriverThread&) = delete;
+    DriverThread& operator=(const DriverThread&) = delete;
+
+    /**
+     * @brief Get the settings used by DriverThread::start.
+     *
+     * @return Current settings
+     */
+    const ThreadSettings& settings() const { return m_settings; }
+
+    /**
+     * @brief Replace the settings, shall be called before DriverThread::start.
+     *
+     * @param settings       New settings
+     */
+    void configure(const ThreadSettings& settings);
+
+    /**
+     * @brief Create the thread and run the body in it.
+     *
+     * @param body           Function run by the thread
+     * @param data           Data passed to body
+     */
+    void start(Body body, void* data);
+
+  private:
+    static void run(void* driver_thread);
+    void apply_settings() const;
+
+    ThreadSettings m_settings;
+    Body m_body;
+    void* m_data;
+    std::unique_ptr<Thread> m_thread;
+};
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,127 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EventLoop.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <sys/epoll.h>
+
+namespace taste {
+
+EventLoop&
+EventLoop::shared()
+{
+    static EventLoop loop;
+    return loop;
+}
+
+EventLoop::EventLoop()
+    : m_epollfd(INVALID_FD)
+    , m_thread(THREAD_PRIORITY, THREAD_STACK_SIZE)
+{
+    m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(m_epollfd == INVALID_FD) {
+        std::cerr << "epoll_create1() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+    m_thread.start(&EventLoopRun, this);
+}
+
+void
+EventLoop::add(const int fd, Handler handler, void* context)
+{
+    registration* const watched = new registration{ handler, context };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_registrations.emplace(fd, watched).second) {
+        std::cerr << "Descriptor is already watched by the event loop" << std::endl;
+        abort();
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = watched;
+    if(epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &event) == EPOLL_ERROR) {
+        std::cerr << "Cannot watch descriptor: " << strerror(errno) << std::endl;
+        abort();
+    }
+}
+
+void
+EventLoop::remove(const int fd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto found = m_registrations.find(fd);
+    if(found == m_registrations.end()) {
+        return;
+    }
+
+    epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+    found->second->handler = nullptr;
+    m_retired.push_back(found->second);
+    m_registrations.erase(found);
+}
+
+void
+EventLoop::run()
+{
+    struct epoll_event events[MAX_EVENTS];
+
+    while(true) {
+        const int epoll_result = epoll_wait(m_epollfd, events, MAX_EVENTS, POLL_NO_TIMEOUT);
+        if(epoll_result == EPOLL_ERROR) {
+            if(errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait() returned an error: " << strerror(errno) << std::endl;
+            std::cerr << "aborting." << std::endl;
+            abort();
+        }
+
+        for(int i = 0; i < epoll_result; ++i) {
+            const registration* const watched = static_cast<registration*>(events[i].data.ptr);
+            if(watched->handler != nullptr) {
+                watched->handler(watched->context, events[i].events);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(registration* const retired : m_retired) {
+            delete retired;
+        }
+        m_retired.clear();
+    }
+}
+
+void
+EventLoopRun(void* loop)
+{
+    EventLoop* self = reinterpret_cast<EventLoop*>(loop);
+    self->run();
+}
+
+} // namespace taste
@@ -0,0 +1,132 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+/**
+ * @file     EventLoop.h
+ * @brief    Single epoll loop receiving for many driver instances.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Thread.h>
+
+namespace taste {
+
+/**
+ * @brief Event loop shared by driver instances which do not need a receiving thread of their own.
+ *
+ * Drivers register non-blocking descriptors with a handler, which is called in the loop thread
+ * whenever the descriptor is readable. Handlers shall never block, because they delay all other
+ * registered descriptors. The loop thread is started when the loop is first used, so partitions
+ * which do not use it pay nothing.
+ */
+class EventLoop final
+{
+  public:
+    /**
+     * @brief Function called in the loop thread when a registered descriptor is ready.
+     *
+     * @param context        Context passed to EventLoop::add
+     * @param events         Ready events, as reported by epoll
+     */
+    typedef void (*Handler)(void* context, uint32_t events);
+
+    /**
+     * @brief Get the loop shared by all drivers of the partition.
+     *
+     * @return The shared loop, started on first call
+     */
+    static EventLoop& shared();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Start calling the handler when the descriptor is readable.
+     *
+     * May be called from any thread.
+     *
+     * @param fd             Non-blocking descriptor to watch
+     * @param handler        Function called when the descriptor is readable
+     * @param context        Context passed to handler
+     */
+    void add(const int fd, Handler handler, void* context);
+
+    /**
+     * @brief Stop watching the descriptor.
+     *
+     * Shall be called from a handler, before the descriptor is closed. The handler
+     * is not called again, even for events already reported for the descriptor.
+     *
+     * @param fd             Descriptor passed to EventLoop::add
+     */
+    void remove(const int fd);
+
+    /**
+     * @brief Dispatch events of registered descriptors.
+     *
+     * This function works in the loop thread and never returns.
+     */
+    void run();
+
+  private:
+    static constexpr int THREAD_PRIORITY = 1;
+    static constexpr int THREAD_STACK_SIZE = 65536;
+    static constexpr int MAX_EVENTS = 64;
+    static constexpr int INVALID_FD = -1;
+    static constexpr int EPOLL_ERROR = -1;
+    static constexpr int POLL_NO_TIMEOUT = -1;
+
+    struct registration
+    {
+        Handler handler;
+        void* context;
+    };
+
+    EventLoop();
+
+    int m_epollfd;
+    std::mutex m_mutex;
+    std::unordered_map<int, registration*> m_registrations;
+    // removed registrations may still be referenced by events of the current batch
+    std::vector<registration*> m_retired;
+    Thread m_thread;
+};
+
+/**
+ * @brief Function which implements the loop thread.
+ *
+ * Functions works in separate thread, which is started by EventLoop::shared
+ *
+ * @param loop           EventLoop to run
+ */
+void EventLoopRun(void* loop);
+
+} // namespace taste
+
+#endif
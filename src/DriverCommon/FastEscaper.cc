@@ -0,0 +1,618 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FastEscaper.h"
+#include "Fragments.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace taste {
+
+namespace {
+
+constexpr size_t BYTE_VALUES = 256;
+// bytes needing escaping are found with one comparison per byte in a vector
+constexpr size_t MAX_SCANNED_BYTES = 4;
+constexpr size_t CALIBRATION_PACKET_SIZE = 1000;
+// an ordinary byte is encoded into one byte and an escaped byte into two,
+// every packet has one start and one stop marker
+constexpr size_t MARKERS_SIZE = 2;
+constexpr size_t ESCAPED_SIZE = 2;
+
+typedef uint8_t scanned_bytes[MAX_SCANNED_BYTES];
+
+// scans from position on with SSE2, if enabled by compiler flags, and a scalar loop
+inline size_t
+find_scanned_from(const uint8_t* const data, const size_t length, const scanned_bytes& bytes, size_t position)
+{
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(static_cast<char>(bytes[0]));
+    const __m128i second = _mm_set1_epi8(static_cast<char>(bytes[1]));
+    const __m128i third = _mm_set1_epi8(static_cast<char>(bytes[2]));
+    const __m128i fourth = _mm_set1_epi8(static_cast<char>(bytes[3]));
+    for(; position + sizeof(__m128i) <= length; position += sizeof(__m128i)) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[position]));
+        const __m128i found =
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, first), _mm_cmpeq_epi8(block, second)),
+                             _mm_or_si128(_mm_cmpeq_epi8(block, third), _mm_cmpeq_epi8(block, fourth)));
+        const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(found));
+        if(mask != 0) {
+            return position + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+    for(; position < length; ++position) {
+        const uint8_t byte = data[position];
+        if(byte == bytes[0] || byte == bytes[1] || byte == bytes[2] || byte == bytes[3]) {
+            return position;
+        }
+    }
+    return length;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// compiled for AVX2 regardless of compiler flags, so it is called only if the CPU supports it
+__attribute__((target("avx2"))) size_t
+find_scanned_avx2(const uint8_t* const data, const size_t length, const scanned_bytes& bytes)
+{
+    size_t position = 0;
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(bytes[0]));
+    const __m256i second = _mm256_set1_epi8(static_cast<char>(bytes[1]));
+    const __m256i third = _mm256_set1_epi8(static_cast<char>(bytes[2]));
+    const __m256i fourth = _mm256_set1_epi8(static_cast<char>(bytes[3]));
+    for(; position + sizeof(__m256i) <= length; position += sizeof(__m256i)) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[position]));
+        const __m256i found = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, first), _mm256_cmpeq_epi8(block, second)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, third), _mm256_cmpeq_epi8(block, fourth)));
+        const unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(found));
+        if(mask != 0) {
+            return position + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return find_scanned_from(data, length, bytes, position);
+}
+#endif
+
+bool
+cpu_supports_avx2()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+inline size_t
+find_scanned(const uint8_t* const data, const size_t length, const scanned_bytes& bytes, const bool avx2)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if(avx2) {
+        return find_scanned_avx2(data, length, bytes);
+    }
+#else
+    (void)avx2;
+#endif
+    return find_scanned_from(data, length, bytes, 0);
+}
+
+// Escaper passes decoded packets to a callback without context,
+// so packets decoded during calibration are collected per thread
+thread_local std::vector<uint8_t>* calibration_packets = nullptr;
+
+void
+append_calibration_packet(std::vector<uint8_t>* const packets, const uint8_t* const data, const size_t length)
+{
+    const uint8_t* const length_bytes = reinterpret_cast<const uint8_t*>(&length);
+    packets->insert(packets->end(), length_bytes, length_bytes + sizeof(length));
+    packets->insert(packets->end(), data, data + length);
+}
+
+void
+collect_calibration_packet(const enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    append_calibration_packet(calibration_packets, data, length);
+}
+
+// decodes the stream with Escaper, collecting the packets
+std::vector<uint8_t>
+decode_calibration_stream(const uint8_t* const stream,
+                          const size_t length,
+                          uint8_t* const decoded_buffer,
+                          const size_t decoded_size)
+{
+    std::vector<uint8_t> packets;
+    calibration_packets = &packets;
+    Escaper escaper;
+    Escaper_init(&escaper, nullptr, 0, decoded_buffer, decoded_size);
+    Escaper_start_decoder(&escaper);
+    Escaper_decode_packet(&escaper, static_cast<enum SystemBus>(0), stream, length, &collect_calibration_packet);
+    calibration_packets = nullptr;
+    return packets;
+}
+
+void
+fill_calibration_packet(uint8_t* const packet)
+{
+    // every byte value in different neighbourhoods, followed by a long run without escapes
+    for(size_t i = 0; i < CALIBRATION_PACKET_SIZE; ++i) {
+        packet[i] = i < 2 * BYTE_VALUES ? static_cast<uint8_t>(i * 7 + i / BYTE_VALUES) : static_cast<uint8_t>(0x55);
+    }
+}
+
+} // namespace
+
+struct FastEscaper::escape_table
+{
+    bool encoder_enabled;
+    bool decoder_enabled;
+    uint8_t start_byte;
+    uint8_t stop_byte;
+    uint8_t escape_byte;
+    // escaped byte is encoded as escape_byte followed by escaped_value
+    bool escaped[BYTE_VALUES];
+    uint8_t escaped_value[BYTE_VALUES];
+    uint8_t unescaped_value[BYTE_VALUES];
+    // bytes needing escaping, and markers found by the decoder, padded by repetition
+    scanned_bytes encoder_scanned;
+    scanned_bytes decoder_scanned;
+    // how Escaper decodes malformed data: escape sequences, which the encoder never produces,
+    // either stand for a byte or abandon the frame, and frames without data may be passed on
+    bool escape_drops_frame[BYTE_VALUES];
+    bool empty_frame_delivered;
+    // scanning uses AVX2, chosen once at run time
+    bool avx2;
+};
+
+FastEscaper::FastEscaper()
+    : m_encoded_buffer(nullptr)
+    , m_encoded_size(0)
+    , m_encode_fallback(false)
+    , m_decoded_buffer(nullptr)
+    , m_decoded_size(0)
+    , m_decoded_length(0)
+    , m_decode_state(DecodeState::Wait)
+{
+}
+
+void
+FastEscaper::init(uint8_t* const encoded_buffer,
+                  const size_t encoded_size,
+                  uint8_t* const decoded_buffer,
+                  const size_t decoded_size)
+{
+    Escaper_init(&m_escaper, encoded_buffer, encoded_size, decoded_buffer, decoded_size);
+    m_encoded_buffer = encoded_buffer;
+    m_encoded_size = encoded_size;
+    m_decoded_buffer = decoded_buffer;
+    m_decoded_size = decoded_size;
+    // calibrate before the driver starts its threads
+    table();
+}
+
+void
+FastEscaper::start_encoder()
+{
+    Escaper_start_encoder(&m_escaper);
+    m_encode_fallback = false;
+}
+
+size_t
+FastEscaper::encode_packet(const uint8_t* const data, const size_t length, size_t* const index)
+{
+    const escape_table& escapes = table();
+    if(!m_encode_fallback && escapes.encoder_enabled && *index == 0
+       && m_encoded_size >= ESCAPED_SIZE * length + MARKERS_SIZE) {
+        *index = length;
+        return encode_with(escapes, data, length, m_encoded_buffer);
+    }
+
+    m_encode_fallback = true;
+    return Escaper_encode_packet(&m_escaper, data, length, index);
+}
+
+size_t
+FastEscaper::encode_fragments(const struct iovec* const fragments, const size_t count, size_t* const index)
+{
+    const escape_table& escapes = table();
+    const size_t length = FragmentsLength(fragments, count);
+    if(!m_encode_fallback && escapes.encoder_enabled && *index == 0
+       && m_encoded_size >= ESCAPED_SIZE * length + MARKERS_SIZE) {
+        size_t output_position = 0;
+        m_encoded_buffer[output_position++] = escapes.start_byte;
+        for(size_t i = 0; i < count; ++i) {
+            output_position += escape_with(escapes,
+                                           static_cast<const uint8_t*>(fragments[i].iov_base),
+                                           fragments[i].iov_len,
+                                           &m_encoded_buffer[output_position]);
+        }
+        m_encoded_buffer[output_position++] = escapes.stop_byte;
+        *index = length;
+        return output_position;
+    }
+
+    if(!m_encode_fallback) {
+        m_gathered.resize(length);
+        FragmentsGather(fragments, count, m_gathered.data());
+        m_encode_fallback = true;
+    }
+    return Escaper_encode_packet(&m_escaper, m_gathered.data(), length, index);
+}
+
+void
+FastEscaper::start_decoder()
+{
+    Escaper_start_decoder(&m_escaper);
+    m_decode_state = DecodeState::Wait;
+    m_decoded_length = 0;
+}
+
+void
+FastEscaper::decode_packet(const enum SystemBus bus_id,
+                           uint8_t* const data,
+                           const size_t length,
+                           ReceivePacketFunction receive)
+{
+    const escape_table& escapes = table();
+    if(escapes.decoder_enabled) {
+        decode_with(escapes, bus_id, data, length, receive);
+    } else {
+        Escaper_decode_packet(&m_escaper, bus_id, data, length, receive);
+    }
+}
+
+const FastEscaper::escape_table&
+FastEscaper::table()
+{
+    static const escape_table escapes = calibrate();
+    return escapes;
+}
+
+FastEscaper::escape_table
+FastEscaper::calibrate()
+{
+    escape_table escapes;
+    memset(&escapes, 0, sizeof(escapes));
+    escapes.avx2 = cpu_supports_avx2();
+
+    Escaper escaper;
+    uint8_t encoded[MARKERS_SIZE + 2 * ESCAPED_SIZE];
+    Escaper_init(&escaper, encoded, sizeof(encoded), nullptr, 0);
+
+    size_t escaped_count = 0;
+    bool escape_known = false;
+    for(size_t value = 0; value < BYTE_VALUES; ++value) {
+        const uint8_t byte = static_cast<uint8_t>(value);
+        size_t index = 0;
+        Escaper_start_encoder(&escaper);
+        const size_t length = Escaper_encode_packet(&escaper, &byte, 1, &index);
+        if(index != 1 || length < MARKERS_SIZE + 1 || length > MARKERS_SIZE + ESCAPED_SIZE) {
+            return escapes;
+        }
+        if(value == 0) {
+            escapes.start_byte = encoded[0];
+            escapes.stop_byte = encoded[length - 1];
+        } else if(encoded[0] != escapes.start_byte || encoded[length - 1] != escapes.stop_byte) {
+            return escapes;
+        }
+
+        if(length == MARKERS_SIZE + 1) {
+            if(encoded[1] != byte) {
+                return escapes;
+            }
+            continue;
+        }
+        if(!escape_known) {
+            escapes.escape_byte = encoded[1];
+            escape_known = true;
+        } else if(encoded[1] != escapes.escape_byte) {
+            return escapes;
+        }
+        if(escaped_count == MAX_SCANNED_BYTES) {
+            return escapes;
+        }
+        escapes.escaped[value] = true;
+        escapes.escaped_value[value] = encoded[2];
+        escapes.unescaped_value[encoded[2]] = byte;
+        escapes.encoder_scanned[escaped_count++] = byte;
+    }
+    if(escaped_count == 0) {
+        return escapes;
+    }
+    for(size_t i = escaped_count; i < MAX_SCANNED_BYTES; ++i) {
+        escapes.encoder_scanned[i] = escapes.encoder_scanned[0];
+    }
+
+    escapes.encoder_enabled = verify_encoder(escapes);
+    if(!escapes.encoder_enabled) {
+        return escapes;
+    }
+
+    // the decoder relies on markers never appearing unescaped inside a frame
+    if(!escapes.escaped[escapes.start_byte] || !escapes.escaped[escapes.stop_byte]
+       || !escapes.escaped[escapes.escape_byte] || escapes.start_byte == escapes.stop_byte) {
+        return escapes;
+    }
+    escapes.decoder_scanned[0] = escapes.start_byte;
+    escapes.decoder_scanned[1] = escapes.stop_byte;
+    escapes.decoder_scanned[2] = escapes.escape_byte;
+    escapes.decoder_scanned[3] = escapes.escape_byte;
+    escapes.decoder_enabled = learn_decoder(escapes) && verify_decoder(escapes);
+    return escapes;
+}
+
+bool
+FastEscaper::verify_encoder(const escape_table& escapes)
+{
+    uint8_t packet[CALIBRATION_PACKET_SIZE];
+    fill_calibration_packet(packet);
+
+    std::vector<uint8_t> expected(ESCAPED_SIZE * CALIBRATION_PACKET_SIZE + MARKERS_SIZE);
+    Escaper escaper;
+    Escaper_init(&escaper, expected.data(), expected.size(), nullptr, 0);
+    Escaper_start_encoder(&escaper);
+    size_t index = 0;
+    const size_t expected_length = Escaper_encode_packet(&escaper, packet, CALIBRATION_PACKET_SIZE, &index);
+    if(index != CALIBRATION_PACKET_SIZE) {
+        return false;
+    }
+
+    std::vector<uint8_t> encoded(expected.size());
+    const size_t length = encode_with(escapes, packet, CALIBRATION_PACKET_SIZE, encoded.data());
+    return length == expected_length && memcmp(encoded.data(), expected.data(), length) == 0;
+}
+
+bool
+FastEscaper::learn_decoder(escape_table& escapes)
+{
+    // ordinary bytes around an escape sequence show its effect on the frame
+    size_t plain_value = 0;
+    while(escapes.escaped[plain_value]) {
+        ++plain_value;
+    }
+    const uint8_t plain = static_cast<uint8_t>(plain_value);
+    uint8_t decoded_buffer[3];
+
+    bool produced[BYTE_VALUES] = {};
+    for(size_t value = 0; value < BYTE_VALUES; ++value) {
+        if(escapes.escaped[value]) {
+            produced[escapes.escaped_value[value]] = true;
+        }
+    }
+
+    for(size_t value = 0; value < BYTE_VALUES; ++value) {
+        const uint8_t stream[] = { escapes.start_byte, plain, escapes.escape_byte, static_cast<uint8_t>(value),
+                                   plain,              escapes.stop_byte,   escapes.start_byte,
+                                   plain,              escapes.stop_byte };
+        const std::vector<uint8_t> decoded =
+                decode_calibration_stream(stream, sizeof(stream), decoded_buffer, sizeof(decoded_buffer));
+
+        const uint8_t unescaped = decoded.size() > sizeof(size_t) + 1 ? decoded[sizeof(size_t) + 1] : 0;
+        const uint8_t kept[] = { plain, unescaped, plain };
+        std::vector<uint8_t> expected;
+        append_calibration_packet(&expected, kept, sizeof(kept));
+        append_calibration_packet(&expected, &plain, 1);
+        if(decoded == expected) {
+            if(produced[value] && escapes.unescaped_value[value] != unescaped) {
+                return false;
+            }
+            escapes.unescaped_value[value] = unescaped;
+            continue;
+        }
+        expected.clear();
+        append_calibration_packet(&expected, &plain, 1);
+        if(produced[value] || decoded != expected) {
+            return false;
+        }
+        escapes.escape_drops_frame[value] = true;
+    }
+
+    const uint8_t stream[] = { escapes.start_byte, escapes.stop_byte, escapes.start_byte, plain, escapes.stop_byte };
+    const std::vector<uint8_t> decoded =
+            decode_calibration_stream(stream, sizeof(stream), decoded_buffer, sizeof(decoded_buffer));
+    std::vector<uint8_t> expected;
+    append_calibration_packet(&expected, &plain, 1);
+    if(decoded == expected) {
+        escapes.empty_frame_delivered = false;
+        return true;
+    }
+    expected.clear();
+    append_calibration_packet(&expected, nullptr, 0);
+    append_calibration_packet(&expected, &plain, 1);
+    escapes.empty_frame_delivered = decoded == expected;
+    return escapes.empty_frame_delivered;
+}
+
+bool
+FastEscaper::verify_decoder(const escape_table& escapes)
+{
+    uint8_t packet[CALIBRATION_PACKET_SIZE];
+    fill_calibration_packet(packet);
+    const uint8_t plain = packet[CALIBRATION_PACKET_SIZE - 1];
+    const uint8_t start = escapes.start_byte;
+    const uint8_t stop = escapes.stop_byte;
+    const uint8_t escape = escapes.escape_byte;
+
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> encoded(ESCAPED_SIZE * CALIBRATION_PACKET_SIZE + MARKERS_SIZE);
+    const auto append_frame = [&](const uint8_t* const data, const size_t length) {
+        const size_t encoded_length = encode_with(escapes, data, length, encoded.data());
+        stream.insert(stream.end(), encoded.begin(), encoded.begin() + static_cast<ptrdiff_t>(encoded_length));
+    };
+
+    // noise before the first frame, then frames of different sizes back to back
+    stream.push_back(static_cast<uint8_t>(start + 1));
+    stream.push_back(stop);
+    append_frame(packet, CALIBRATION_PACKET_SIZE);
+    append_frame(&start, 1);
+    append_frame(packet + 1, 1);
+    // malformed data: an empty frame, a frame restarted by a start marker,
+    // escape sequences which the encoder never produces
+    stream.insert(stream.end(), { start, stop, start, plain, plain, start, plain, stop });
+    stream.insert(stream.end(), { start, plain, escape, plain, plain, stop, start, escape, start, plain, stop });
+    stream.insert(stream.end(), { start, escape, stop, start, escape, escape, plain, stop });
+    // frames overflowing the decoded packet buffer, at an ordinary byte and at an escape sequence
+    stream.push_back(start);
+    stream.insert(stream.end(), CALIBRATION_PACKET_SIZE + 1, plain);
+    stream.push_back(stop);
+    append_frame(packet + 2, 2);
+    stream.push_back(start);
+    stream.insert(stream.end(), CALIBRATION_PACKET_SIZE, plain);
+    stream.insert(stream.end(), { escape, escapes.escaped_value[stop], plain, stop });
+    append_frame(packet + 3, 3);
+
+    std::vector<uint8_t> decoded_buffer(CALIBRATION_PACKET_SIZE);
+    const std::vector<uint8_t> expected =
+            decode_calibration_stream(stream.data(), stream.size(), decoded_buffer.data(), decoded_buffer.size());
+
+    // small chunks exercise decoder state kept between calls
+    std::vector<uint8_t> decoded;
+    calibration_packets = &decoded;
+    FastEscaper fast;
+    fast.m_decoded_buffer = decoded_buffer.data();
+    fast.m_decoded_size = decoded_buffer.size();
+    constexpr size_t CHUNK_SIZE = 37;
+    for(size_t position = 0; position < stream.size(); position += CHUNK_SIZE) {
+        const size_t chunk = stream.size() - position < CHUNK_SIZE ? stream.size() - position : CHUNK_SIZE;
+        fast.decode_with(
+                escapes, static_cast<enum SystemBus>(0), &stream[position], chunk, &collect_calibration_packet);
+    }
+    calibration_packets = nullptr;
+
+    return !expected.empty() && expected == decoded;
+}
+
+size_t
+FastEscaper::encode_with(const escape_table& escapes,
+                         const uint8_t* const data,
+                         const size_t length,
+                         uint8_t* const output)
+{
+    size_t output_position = 0;
+    output[output_position++] = escapes.start_byte;
+    output_position += escape_with(escapes, data, length, &output[output_position]);
+    output[output_position++] = escapes.stop_byte;
+    return output_position;
+}
+
+size_t
+FastEscaper::escape_with(const escape_table& escapes,
+                         const uint8_t* const data,
+                         const size_t length,
+                         uint8_t* const output)
+{
+    size_t output_position = 0;
+    size_t position = 0;
+    while(position < length) {
+        const size_t run = find_scanned(&data[position], length - position, escapes.encoder_scanned, escapes.avx2);
+        memcpy(&output[output_position], &data[position], run);
+        output_position += run;
+        position += run;
+        if(position == length) {
+            break;
+        }
+        output[output_position++] = escapes.escape_byte;
+        output[output_position++] = escapes.escaped_value[data[position++]];
+    }
+    return output_position;
+}
+
+void
+FastEscaper::decode_with(const escape_table& escapes,
+                         const enum SystemBus bus_id,
+                         uint8_t* const data,
+                         const size_t length,
+                         ReceivePacketFunction receive)
+{
+    size_t position = 0;
+    while(position < length) {
+        switch(m_decode_state) {
+            case DecodeState::Wait: {
+                const void* const start = memchr(&data[position], escapes.start_byte, length - position);
+                if(start == nullptr) {
+                    return;
+                }
+                position = static_cast<size_t>(static_cast<const uint8_t*>(start) - data) + 1;
+                m_decoded_length = 0;
+                m_decode_state = DecodeState::Normal;
+                break;
+            }
+            case DecodeState::Normal: {
+                const size_t run =
+                        find_scanned(&data[position], length - position, escapes.decoder_scanned, escapes.avx2);
+                if(run > m_decoded_size - m_decoded_length) {
+                    // too long for the decoded packet buffer
+                    m_decode_state = DecodeState::Wait;
+                    position += run;
+                    break;
+                }
+                if(m_decoded_length == 0 && run < length - position && data[position + run] == escapes.stop_byte) {
+                    // the whole frame was received at once without escapes, so it needs no copying
+                    if(run != 0 || escapes.empty_frame_delivered) {
+                        receive(bus_id, &data[position], run);
+                    }
+                    position += run + 1;
+                    m_decode_state = DecodeState::Wait;
+                    break;
+                }
+                memcpy(&m_decoded_buffer[m_decoded_length], &data[position], run);
+                m_decoded_length += run;
+                position += run;
+                if(position == length) {
+                    return;
+                }
+                const uint8_t marker = data[position++];
+                if(marker == escapes.start_byte) {
+                    m_decoded_length = 0;
+                } else if(marker == escapes.stop_byte) {
+                    if(m_decoded_length != 0 || escapes.empty_frame_delivered) {
+                        receive(bus_id, m_decoded_buffer, m_decoded_length);
+                    }
+                    m_decode_state = DecodeState::Wait;
+                } else {
+                    m_decode_state = DecodeState::Escape;
+                }
+                break;
+            }
+            case DecodeState::Escape: {
+                const uint8_t escaped = data[position++];
+                if(escapes.escape_drops_frame[escaped] || m_decoded_length == m_decoded_size) {
+                    m_decode_state = DecodeState::Wait;
+                    break;
+                }
+                m_decoded_buffer[m_decoded_length++] = escapes.unescaped_value[escaped];
+                m_decode_state = DecodeState::Normal;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace taste
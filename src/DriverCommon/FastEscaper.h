@@ -0,0 +1,188 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAST_ESCAPER_H
+#define FAST_ESCAPER_H
+
+/**
+ * @file     FastEscaper.h
+ * @brief    Escaper with vectorized scanning for bytes which need escaping.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <system_spec.h>
+
+extern "C"
+{
+#include <Escaper.h>
+}
+
+namespace taste {
+
+/**
+ * @brief Drop-in replacement of Escaper, which copies runs of ordinary bytes in bulk.
+ *
+ * Markers and escape sequences are not hardcoded; they are learned once by encoding
+ * every byte value with Escaper, and by decoding every possible escape sequence and an empty
+ * frame with it. The result of encoding and decoding a test stream, including malformed frames,
+ * is then compared with Escaper. If anything differs, or the escaping scheme cannot be scanned
+ * for efficiently, all calls are forwarded to Escaper, so the output is always identical.
+ *
+ * Scanning uses AVX2 if the CPU supports it, regardless of compiler flags, otherwise SSE2
+ * if enabled by compiler flags, and a scalar loop on other architectures.
+ */
+class FastEscaper final
+{
+  public:
+    /**
+     * @brief Function receiving decoded packets, the same as passed to Escaper_decode_packet.
+     */
+    typedef void (*ReceivePacketFunction)(enum SystemBus bus_id, uint8_t* const data, const size_t length);
+
+    /**
+     * @brief  Constructor.
+     *
+     * Construct empty object, which needs to be initialized using FastEscaper::init
+     * before usage.
+     */
+    FastEscaper();
+
+    FastEscaper(const FastEscaper&) = delete;
+    FastEscaper& operator=(const FastEscaper&) = delete;
+
+    /**
+     * @brief Initialize the escaper, like Escaper_init.
+     *
+     * @param encoded_buffer       Buffer for encoded data, may be null if only decoding
+     * @param encoded_size         The size of encoded_buffer
+     * @param decoded_buffer       Buffer for decoded packets, may be null if only encoding
+     * @param decoded_size         The size of decoded_buffer
+     */
+    void init(uint8_t* const encoded_buffer,
+              const size_t encoded_size,
+              uint8_t* const decoded_buffer,
+              const size_t decoded_size);
+
+    /**
+     * @brief Prepare to encode a new packet, like Escaper_start_encoder.
+     */
+    void start_encoder();
+
+    /**
+     * @brief Encode next part of the packet into the encoded buffer, like Escaper_encode_packet.
+     *
+     * If the encoded buffer can hold the whole escaped packet, it is encoded with one call.
+     *
+     * @param data           Packet to encode
+     * @param length         The size of the packet
+     * @param index          Index of the first byte to encode, updated past the encoded bytes
+     *
+     * @return The number of bytes placed in the encoded buffer
+     */
+    size_t encode_packet(const uint8_t* const data, const size_t length, size_t* const index);
+
+    /**
+     * @brief Encode next part of a packet made of fragments, as if they were one buffer.
+     *
+     * If the encoded buffer can hold the whole escaped packet, the fragments are encoded
+     * directly; otherwise they are first gathered into an internal buffer.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     * @param index          Index of the first byte to encode, updated past the encoded bytes
+     *
+     * @return The number of bytes placed in the encoded buffer
+     */
+    size_t encode_fragments(const struct iovec* const fragments, const size_t count, size_t* const index);
+
+    /**
+     * @brief Discard partially decoded packet, like Escaper_start_decoder.
+     */
+    void start_decoder();
+
+    /**
+     * @brief Decode received data, like Escaper_decode_packet.
+     *
+     * A frame which lies entirely in data and contains no escape sequences is passed
+     * to the receive function as a pointer into data, without copying it into
+     * the decoded packet buffer.
+     *
+     * @param bus_id         Bus passed to the receive function
+     * @param data           Received data
+     * @param length         The size of the data
+     * @param receive        Function called for every decoded packet
+     */
+    void decode_packet(const enum SystemBus bus_id,
+                       uint8_t* const data,
+                       const size_t length,
+                       ReceivePacketFunction receive);
+
+  private:
+    struct escape_table;
+
+    enum class DecodeState
+    {
+        Wait,
+        Normal,
+        Escape
+    };
+
+    static const escape_table& table();
+    static escape_table calibrate();
+    static bool verify_encoder(const escape_table& escapes);
+    static bool learn_decoder(escape_table& escapes);
+    static bool verify_decoder(const escape_table& escapes);
+
+    static size_t encode_with(const escape_table& escapes,
+                              const uint8_t* const data,
+                              const size_t length,
+                              uint8_t* const output);
+    static size_t escape_with(const escape_table& escapes,
+                              const uint8_t* const data,
+                              const size_t length,
+                              uint8_t* const output);
+    void decode_with(const escape_table& escapes,
+                     const enum SystemBus bus_id,
+                     uint8_t* const data,
+                     const size_t length,
+                     ReceivePacketFunction receive);
+
+    Escaper m_escaper;
+    uint8_t* m_encoded_buffer;
+    size_t m_encoded_size;
+    bool m_encode_fallback;
+    // fragments gathered for Escaper, allocated only if it is used
+    std::vector<uint8_t> m_gathered;
+    uint8_t* m_decoded_buffer;
+    size_t m_decoded_size;
+    size_t m_decoded_length;
+    DecodeState m_decode_state;
+};
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,75 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAGMENTS_H
+#define FRAGMENTS_H
+
+/**
+ * @file     Fragments.h
+ * @brief    Helpers for packets passed to drivers as a list of fragments.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/uio.h>
+
+namespace taste {
+
+/**
+ * @brief Get the size of a packet made of fragments.
+ *
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ *
+ * @return Sum of fragment sizes
+ */
+inline size_t
+FragmentsLength(const struct iovec* const fragments, const size_t count)
+{
+    size_t length = 0;
+    for(size_t i = 0; i < count; ++i) {
+        length += fragments[i].iov_len;
+    }
+    return length;
+}
+
+/**
+ * @brief Copy fragments of a packet into one buffer.
+ *
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ * @param output         Buffer for the packet, at least FragmentsLength bytes
+ */
+inline void
+FragmentsGather(const struct iovec* const fragments, const size_t count, uint8_t* output)
+{
+    for(size_t i = 0; i < count; ++i) {
+        memcpy(output, fragments[i].iov_base, fragments[i].iov_len);
+        output += fragments[i].iov_len;
+    }
+}
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,269 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PacketCompressor.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace taste {
+
+namespace {
+
+constexpr uint8_t HEADER_STORED = 0;
+constexpr uint8_t HEADER_COMPRESSED = 1;
+
+// every sequence is a token with literal and match lengths in its nibbles, extra literal
+// length bytes, literals, 16-bit little endian match offset and extra match length bytes;
+// the last sequence has only literals
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned int LENGTH_NIBBLE_MAX = 15;
+constexpr size_t OFFSET_SIZE = 2;
+
+inline uint32_t
+read32(const uint8_t* const data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline size_t
+extra_length_size(const size_t length)
+{
+    return length < LENGTH_NIBBLE_MAX ? 0 : (length - LENGTH_NIBBLE_MAX) / 255 + 1;
+}
+
+inline uint8_t*
+write_extra_length(uint8_t* output, size_t length)
+{
+    if(length < LENGTH_NIBBLE_MAX) {
+        return output;
+    }
+    length -= LENGTH_NIBBLE_MAX;
+    while(length >= 255) {
+        *output++ = 255;
+        length -= 255;
+    }
+    *output++ = static_cast<uint8_t>(length);
+    return output;
+}
+
+inline bool
+read_extra_length(const uint8_t* const data, const size_t length, size_t* const position, size_t* const value)
+{
+    if(*value < LENGTH_NIBBLE_MAX) {
+        return true;
+    }
+    uint8_t byte = 255;
+    while(byte == 255) {
+        if(*position >= length) {
+            return false;
+        }
+        byte = data[(*position)++];
+        *value += byte;
+    }
+    return true;
+}
+
+} // namespace
+
+PacketCompressor::PacketCompressor()
+    : m_packets(0)
+    , m_bypassed(0)
+    , m_input_bytes(0)
+    , m_output_bytes(0)
+{
+    memset(m_hash_table, 0, sizeof(m_hash_table));
+}
+
+size_t
+PacketCompressor::compress(const uint8_t* const data, const size_t length, uint8_t* const output)
+{
+    size_t output_length = compress_sequences(data, length, output + HEADER_SIZE);
+    if(output_length != 0) {
+        output[0] = HEADER_COMPRESSED;
+        output_length += HEADER_SIZE;
+    } else {
+        m_bypassed.fetch_add(1, std::memory_order_relaxed);
+        output[0] = HEADER_STORED;
+        memcpy(output + HEADER_SIZE, data, length);
+        output_length = HEADER_SIZE + length;
+    }
+
+    m_packets.fetch_add(1, std::memory_order_relaxed);
+    m_input_bytes.fetch_add(length, std::memory_order_relaxed);
+    m_output_bytes.fetch_add(output_length, std::memory_order_relaxed);
+    return output_length;
+}
+
+size_t
+PacketCompressor::compress_sequences(const uint8_t* const data, const size_t length, uint8_t* const output)
+{
+    // compressed data shall be shorter than the packet, otherwise it is stored
+    const size_t limit = length;
+    if(length <= MIN_MATCH) {
+        return 0;
+    }
+
+    size_t output_position = 0;
+    size_t anchor = 0;
+    size_t position = 0;
+    while(position + MIN_MATCH <= length) {
+        const uint32_t sequence = read32(&data[position]);
+        const size_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        const size_t candidate = m_hash_table[hash];
+        m_hash_table[hash] = static_cast<uint32_t>(position);
+
+        if(candidate >= position || position - candidate > MAX_OFFSET || read32(&data[candidate]) != sequence) {
+            ++position;
+            continue;
+        }
+
+        size_t match_length = MIN_MATCH;
+        while(position + match_length < length && data[candidate + match_length] == data[position + match_length]) {
+            ++match_length;
+        }
+
+        const size_t literal_length = position - anchor;
+        const size_t match_code = match_length - MIN_MATCH;
+        const size_t sequence_size = 1 + extra_length_size(literal_length) + literal_length + OFFSET_SIZE
+                                     + extra_length_size(match_code);
+        if(output_position + sequence_size >= limit) {
+            return 0;
+        }
+
+        uint8_t* out = &output[output_position];
+        *out++ = static_cast<uint8_t>((std::min<size_t>(literal_length, LENGTH_NIBBLE_MAX) << 4)
+                                      | std::min<size_t>(match_code, LENGTH_NIBBLE_MAX));
+        out = write_extra_length(out, literal_length);
+        memcpy(out, &data[anchor], literal_length);
+        out += literal_length;
+        const size_t offset = position - candidate;
+        *out++ = static_cast<uint8_t>(offset);
+        *out++ = static_cast<uint8_t>(offset >> 8);
+        out = write_extra_length(out, match_code);
+        output_position = static_cast<size_t>(out - output);
+
+        position += match_length;
+        anchor = position;
+    }
+
+    const size_t literal_length = length - anchor;
+    const size_t sequence_size = 1 + extra_length_size(literal_length) + literal_length;
+    if(output_position + sequence_size >= limit) {
+        return 0;
+    }
+    uint8_t* out = &output[output_position];
+    *out++ = static_cast<uint8_t>(std::min<size_t>(literal_length, LENGTH_NIBBLE_MAX) << 4);
+    out = write_extra_length(out, literal_length);
+    memcpy(out, &data[anchor], literal_length);
+    out += literal_length;
+    return static_cast<size_t>(out - output);
+}
+
+CompressionStatistics
+PacketCompressor::statistics() const
+{
+    CompressionStatistics result;
+    result.packets = m_packets.load(std::memory_order_relaxed);
+    result.bypassed = m_bypassed.load(std::memory_order_relaxed);
+    result.input_bytes = m_input_bytes.load(std::memory_order_relaxed);
+    result.output_bytes = m_output_bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+bool
+PacketCompressor::is_stored(const uint8_t* const data, const size_t length)
+{
+    return length >= HEADER_SIZE && data[0] == HEADER_STORED;
+}
+
+bool
+PacketCompressor::decompress(const uint8_t* const data,
+                             const size_t length,
+                             uint8_t* const output,
+                             const size_t capacity,
+                             size_t* const output_length)
+{
+    if(length < HEADER_SIZE) {
+        return false;
+    }
+    if(data[0] == HEADER_STORED) {
+        if(length - HEADER_SIZE > capacity) {
+            return false;
+        }
+        memcpy(output, data + HEADER_SIZE, length - HEADER_SIZE);
+        *output_length = length - HEADER_SIZE;
+        return true;
+    }
+    if(data[0] != HEADER_COMPRESSED) {
+        return false;
+    }
+
+    size_t position = HEADER_SIZE;
+    size_t output_position = 0;
+    while(position < length) {
+        const uint8_t token = data[position++];
+
+        size_t literal_length = token >> 4;
+        if(!read_extra_length(data, length, &position, &literal_length)) {
+            return false;
+        }
+        if(literal_length > length - position || literal_length > capacity - output_position) {
+            return false;
+        }
+        memcpy(&output[output_position], &data[position], literal_length);
+        position += literal_length;
+        output_position += literal_length;
+
+        if(position == length) {
+            // the last sequence has no match
+            break;
+        }
+
+        if(length - position < OFFSET_SIZE) {
+            return false;
+        }
+        const size_t offset = static_cast<size_t>(data[position]) | (static_cast<size_t>(data[position + 1]) << 8);
+        position += OFFSET_SIZE;
+        size_t match_length = token & LENGTH_NIBBLE_MAX;
+        if(!read_extra_length(data, length, &position, &match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if(offset == 0 || offset > output_position || match_length > capacity - output_position) {
+            return false;
+        }
+        // the match may overlap with its own output, so it is copied byte by byte
+        for(size_t i = 0; i < match_length; ++i) {
+            output[output_position + i] = output[output_position - offset + i];
+        }
+        output_position += match_length;
+    }
+
+    *output_length = output_position;
+    return true;
+}
+
+} // namespace taste
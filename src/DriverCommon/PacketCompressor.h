@@ -0,0 +1,138 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PACKET_COMPRESSOR_H
+#define PACKET_COMPRESSOR_H
+
+/**
+ * @file     PacketCompressor.h
+ * @brief    Per-packet LZ compression with bypass of incompressible data.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace taste {
+
+/**
+ * @brief Counters describing the work of a PacketCompressor.
+ *
+ * The achieved compression ratio is input_bytes / output_bytes.
+ */
+struct CompressionStatistics
+{
+    uint64_t packets;      ///< Number of compressed packets
+    uint64_t bypassed;     ///< Number of packets sent uncompressed, because they would not shrink
+    uint64_t input_bytes;  ///< Total size of packets before compression
+    uint64_t output_bytes; ///< Total size of packets after compression, including headers
+};
+
+/**
+ * @brief LZ77 compressor of single packets.
+ *
+ * Every packet is compressed independently, so a lost packet does not affect others.
+ * The output starts with a one byte header, which tells if the rest is compressed or
+ * stored as is; a packet never grows by more than this header.
+ * The only state is a fixed size hash table of recent positions.
+ */
+class PacketCompressor final
+{
+  public:
+    /// Size of the header preceding every packet
+    static constexpr size_t HEADER_SIZE = 1;
+
+    /**
+     * @brief  Constructor.
+     */
+    PacketCompressor();
+
+    PacketCompressor(const PacketCompressor&) = delete;
+    PacketCompressor& operator=(const PacketCompressor&) = delete;
+
+    /**
+     * @brief Compress a packet.
+     *
+     * @param data           Packet to compress
+     * @param length         The size of the packet
+     * @param output         Buffer for the result, at least HEADER_SIZE + length bytes
+     *
+     * @return The size of the result
+     */
+    size_t compress(const uint8_t* const data, const size_t length, uint8_t* const output);
+
+    /**
+     * @brief Get compression counters.
+     *
+     * @return Snapshot of the counters
+     */
+    CompressionStatistics statistics() const;
+
+    /**
+     * @brief Check if a compressed packet was stored as is.
+     *
+     * The original packet is then placed right after the header.
+     *
+     * @param data           Result of compress
+     * @param length         The size of the result
+     *
+     * @return true if the packet was not compressed
+     */
+    static bool is_stored(const uint8_t* const data, const size_t length);
+
+    /**
+     * @brief Restore a packet compressed by PacketCompressor::compress.
+     *
+     * Malformed input is detected and never causes reading or writing out of bounds.
+     *
+     * @param data           Result of compress
+     * @param length         The size of the result
+     * @param output         Buffer for the original packet
+     * @param capacity       The size of the output buffer
+     * @param output_length  Set to the size of the original packet
+     *
+     * @return true if the packet was restored, false if it is malformed
+     */
+    static bool decompress(const uint8_t* const data,
+                           const size_t length,
+                           uint8_t* const output,
+                           const size_t capacity,
+                           size_t* const output_length);
+
+  private:
+    static constexpr unsigned int HASH_BITS = 12;
+    static constexpr size_t HASH_TABLE_SIZE = 1u << HASH_BITS;
+
+    size_t compress_sequences(const uint8_t* const data, const size_t length, uint8_t* const output);
+
+    // positions are not cleared between packets, every candidate match is verified
+    uint32_t m_hash_table[HASH_TABLE_SIZE];
+
+    std::atomic<uint64_t> m_packets;
+    std::atomic<uint64_t> m_bypassed;
+    std::atomic<uint64_t> m_input_bytes;
+    std::atomic<uint64_t> m_output_bytes;
+};
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,273 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SendQueue.h"
+#include "Fragments.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace taste {
+
+SendQueue::SendQueue(int thread_priority, int thread_stack_size)
+    : m_capacity(0)
+    , m_max_packet_size(0)
+    , m_policy(SendQueuePolicy::Block)
+    , m_enqueue_position(0)
+    , m_dequeue_position(0)
+    , m_max_depth(0)
+    , m_enqueued(0)
+    , m_sent(0)
+    , m_dropped(0)
+    , m_rejected(0)
+    , m_send_function(nullptr)
+    , m_flush_function(nullptr)
+    , m_send_context(nullptr)
+    , m_thread(thread_priority, thread_stack_size)
+{
+}
+
+SendQueue::~SendQueue()
+{
+    if(m_capacity != 0) {
+        sem_destroy(&m_pending);
+        sem_destroy(&m_free);
+    }
+}
+
+void
+SendQueue::init(const size_t capacity, const SendQueuePolicy policy, const size_t max_packet_size)
+{
+    m_slots.reset(new slot[capacity]);
+    m_storage.reset(new uint8_t[capacity * max_packet_size]);
+    m_sending_packet.reset(new uint8_t[max_packet_size]);
+    for(size_t i = 0; i < capacity; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        m_slots[i].length = 0;
+    }
+
+    sem_init(&m_pending, 0, 0);
+    sem_init(&m_free, 0, static_cast<unsigned int>(capacity));
+
+    m_policy = policy;
+    m_max_packet_size = max_packet_size;
+    m_capacity = capacity;
+}
+
+void
+SendQueue::start(SendFunction send_function, void* context, FlushFunction flush_function)
+{
+    m_send_function = send_function;
+    m_flush_function = flush_function;
+    m_send_context = context;
+    m_thread.start(&SendQueueDrain, this);
+}
+
+SendQueuePushResult
+SendQueue::push(const uint8_t* data, const size_t length)
+{
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    return push(&fragment, 1);
+}
+
+SendQueuePushResult
+SendQueue::push(const struct iovec* const fragments, const size_t count)
+{
+    const size_t length = FragmentsLength(fragments, count);
+    if(!is_enabled() || length > m_max_packet_size) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return SendQueuePushResult::TooLarge;
+    }
+
+    switch(m_policy) {
+        case SendQueuePolicy::Block:
+            wait(&m_free);
+            while(!try_push(fragments, count, length)) {
+                std::this_thread::yield();
+            }
+            break;
+        case SendQueuePolicy::DropOldest:
+            while(!try_push(fragments, count, length)) {
+                slot* oldest = nullptr;
+                size_t position = 0;
+                if(try_pop(&oldest, &position)) {
+                    release(oldest, position);
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    // the oldest packet is still being pushed by another thread
+                    std::this_thread::yield();
+                }
+            }
+            break;
+        case SendQueuePolicy::Reject:
+            if(!try_push(fragments, count, length)) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                return SendQueuePushResult::Full;
+            }
+            break;
+    }
+
+    m_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t depth =
+            m_enqueue_position.load(std::memory_order_relaxed) - m_dequeue_position.load(std::memory_order_relaxed);
+    size_t max_depth = m_max_depth.load(std::memory_order_relaxed);
+    while(depth > max_depth && !m_max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+    }
+
+    sem_post(&m_pending);
+    return SendQueuePushResult::Queued;
+}
+
+void
+SendQueue::add_dropped(const uint64_t count)
+{
+    m_dropped.fetch_add(count, std::memory_order_relaxed);
+}
+
+SendQueueStatistics
+SendQueue::statistics() const
+{
+    SendQueueStatistics result;
+    const size_t dequeue_position = m_dequeue_position.load(std::memory_order_relaxed);
+    const size_t enqueue_position = m_enqueue_position.load(std::memory_order_relaxed);
+    result.depth = enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+    result.max_depth = m_max_depth.load(std::memory_order_relaxed);
+    result.enqueued = m_enqueued.load(std::memory_order_relaxed);
+    result.sent = m_sent.load(std::memory_order_relaxed);
+    result.dropped = m_dropped.load(std::memory_order_relaxed);
+    result.rejected = m_rejected.load(std::memory_order_relaxed);
+    return result;
+}
+
+void
+SendQueue::drain()
+{
+    while(true) {
+        wait(&m_pending);
+
+        // a wakeup may cover more than one packet, e.g. when an earlier push was still in progress
+        slot* packet = nullptr;
+        size_t position = 0;
+        while(try_pop(&packet, &position)) {
+            const size_t length = packet->length;
+            memcpy(m_sending_packet.get(), slot_data(position), length);
+            release(packet, position);
+            m_send_function(m_send_context, m_sending_packet.get(), length);
+            m_sent.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if(m_flush_function != nullptr) {
+            m_flush_function(m_send_context);
+        }
+    }
+}
+
+bool
+SendQueue::try_push(const struct iovec* const fragments, const size_t count, const size_t length)
+{
+    size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+    slot* target = nullptr;
+    while(true) {
+        target = &m_slots[position % m_capacity];
+        const size_t sequence = target->sequence.load(std::memory_order_acquire);
+        const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+        if(difference == 0) {
+            if(m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if(difference < 0) {
+            // full
+            return false;
+        } else {
+            position = m_enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    FragmentsGather(fragments, count, slot_data(position));
+    target->length = length;
+    target->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+SendQueue::try_pop(slot** popped, size_t* position)
+{
+    size_t current = m_dequeue_position.load(std::memory_order_relaxed);
+    while(true) {
+        slot* const candidate = &m_slots[current % m_capacity];
+        const size_t sequence = candidate->sequence.load(std::memory_order_acquire);
+        const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(current + 1);
+        if(difference == 0) {
+            if(m_dequeue_position.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) {
+                *popped = candidate;
+                *position = current;
+                return true;
+            }
+        } else if(difference < 0) {
+            // empty or the next packet is not fully pushed yet
+            return false;
+        } else {
+            current = m_dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+SendQueue::release(slot* const popped, const size_t position)
+{
+    popped->sequence.store(position + m_capacity, std::memory_order_release);
+    if(m_policy == SendQueuePolicy::Block) {
+        sem_post(&m_free);
+    }
+}
+
+uint8_t*
+SendQueue::slot_data(const size_t position) const
+{
+    return &m_storage[(position % m_capacity) * m_max_packet_size];
+}
+
+void
+SendQueue::wait(sem_t* const semaphore)
+{
+    while(sem_wait(semaphore) != 0) {
+        if(errno != EINTR) {
+            std::cerr << "sem_wait() returned an error: " << strerror(errno) << std::endl;
+            abort();
+        }
+    }
+}
+
+void
+SendQueueDrain(void* queue)
+{
+    SendQueue* self = reinterpret_cast<SendQueue*>(queue);
+    self->drain();
+}
+
+} // namespace taste
@@ -0,0 +1,235 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEND_QUEUE_H
+#define SEND_QUEUE_H
+
+/**
+ * @file     SendQueue.h
+ * @brief    Bounded queue of outgoing packets drained by a dedicated thread.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <semaphore.h>
+#include <sys/uio.h>
+
+#include <Thread.h>
+
+namespace taste {
+
+/**
+ * @brief Behaviour of SendQueue::push when the queue is full.
+ */
+enum class SendQueuePolicy
+{
+    Block,      ///< Wait until the sending thread frees a slot
+    DropOldest, ///< Discard the oldest queued packet
+    Reject      ///< Discard the pushed packet
+};
+
+/**
+ * @brief Outcome of SendQueue::push.
+ */
+enum class SendQueuePushResult
+{
+    Queued,   ///< The packet was queued
+    Full,     ///< The queue is full and the policy is Reject
+    TooLarge  ///< The packet does not fit in a slot, or the queue is disabled
+};
+
+/**
+ * @brief Counters describing the state of a SendQueue.
+ */
+struct SendQueueStatistics
+{
+    size_t depth;      ///< Number of packets currently queued
+    size_t max_depth;  ///< Highest number of packets queued at once
+    uint64_t enqueued; ///< Number of packets accepted by push
+    uint64_t sent;     ///< Number of packets passed to the send function
+    uint64_t dropped;  ///< Number of queued packets discarded by DropOldest policy or lost by the sender
+    uint64_t rejected; ///< Number of packets refused by push
+};
+
+/**
+ * @brief Bounded lock-free queue of outgoing packets.
+ *
+ * Packets pushed by any number of threads are copied into preallocated slots
+ * and passed, in order, to the send function by the queue's own thread.
+ * The queue is disabled until SendQueue::init is called.
+ */
+class SendQueue final
+{
+  public:
+    /**
+     * @brief Function used by the queue thread to transmit a packet.
+     *
+     * @param context        Context passed to SendQueue::start
+     * @param data           Packet to transmit
+     * @param length         The size of the packet
+     */
+    typedef void (*SendFunction)(void* context, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Function called by the queue thread after it sent all queued packets.
+     *
+     * Allows the send function to only buffer packets and transmit them together.
+     *
+     * @param context        Context passed to SendQueue::start
+     */
+    typedef void (*FlushFunction)(void* context);
+
+    /**
+     * @brief  Constructor.
+     *
+     * @param thread_priority    Priority of the sending thread
+     * @param thread_stack_size  Stack size of the sending thread
+     */
+    SendQueue(int thread_priority, int thread_stack_size);
+
+    /**
+     * @brief  Destructor.
+     */
+    ~SendQueue();
+
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    /**
+     * @brief Allocate the queue.
+     *
+     * @param capacity         Maximum number of queued packets
+     * @param policy           Behaviour of push when the queue is full
+     * @param max_packet_size  Maximum size of a single packet
+     */
+    void init(const size_t capacity, const SendQueuePolicy policy, const size_t max_packet_size);
+
+    /**
+     * @brief Start the sending thread.
+     *
+     * @param send_function  Function called for every queued packet
+     * @param context        Context passed to send_function and flush_function
+     * @param flush_function Optional function called when the queue becomes empty
+     */
+    void start(SendFunction send_function, void* context, FlushFunction flush_function = nullptr);
+
+    /**
+     * @brief Check if the queue was initialized.
+     *
+     * @return true if packets should be pushed into the queue
+     */
+    bool is_enabled() const { return m_capacity != 0; }
+
+    /**
+     * @brief Queue a copy of the packet.
+     *
+     * @param data           Packet to queue
+     * @param length         The size of the packet
+     *
+     * @return Whether the packet was queued or why it was rejected
+     */
+    SendQueuePushResult push(const uint8_t* data, const size_t length);
+
+    /**
+     * @brief Queue a packet made of fragments, copying them into one slot.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     *
+     * @return Whether the packet was queued or why it was rejected
+     */
+    SendQueuePushResult push(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Count packets, which were taken from the queue but could not be transmitted.
+     *
+     * @param count          Number of lost packets
+     */
+    void add_dropped(const uint64_t count);
+
+    /**
+     * @brief Get queue counters.
+     *
+     * @return Snapshot of the counters
+     */
+    SendQueueStatistics statistics() const;
+
+    /**
+     * @brief Send queued packets.
+     *
+     * This function works in the queue thread and never returns.
+     */
+    void drain();
+
+  private:
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        size_t length;
+    };
+
+    bool try_push(const struct iovec* const fragments, const size_t count, const size_t length);
+    bool try_pop(slot** popped, size_t* position);
+    void release(slot* const popped, const size_t position);
+    uint8_t* slot_data(const size_t position) const;
+    void wait(sem_t* const semaphore);
+
+    size_t m_capacity;
+    size_t m_max_packet_size;
+    SendQueuePolicy m_policy;
+    std::unique_ptr<slot[]> m_slots;
+    std::unique_ptr<uint8_t[]> m_storage;
+    // the packet being sent is copied out of its slot, so a full queue always has an oldest packet to drop
+    std::unique_ptr<uint8_t[]> m_sending_packet;
+
+    std::atomic<size_t> m_enqueue_position;
+    std::atomic<size_t> m_dequeue_position;
+    sem_t m_pending;
+    sem_t m_free;
+
+    std::atomic<size_t> m_max_depth;
+    std::atomic<uint64_t> m_enqueued;
+    std::atomic<uint64_t> m_sent;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_rejected;
+
+    SendFunction m_send_function;
+    FlushFunction m_flush_function;
+    void* m_send_context;
+    taste::Thread m_thread;
+};
+
+/**
+ * @brief Function which implements sending queued packets.
+ *
+ * Functions works in separate thread, which is started by SendQueue::start
+ *
+ * @param queue          SendQueue to drain
+ */
+void SendQueueDrain(void* queue);
+
+} // namespace taste
+
+#endif
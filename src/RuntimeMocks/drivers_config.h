@@ -40,9 +40,62 @@ typedef enum
 #define Version_T_ipv4 ipv4
 #define Version_T_ipv6 ipv6
 
+typedef enum
+{
+    Send_Queue_Policy_T_block = 0,
+    Send_Queue_Policy_T_drop_oldest = 1,
+    Send_Queue_Policy_T_reject = 2
+} Send_Queue_Policy_T;
+
+typedef enum
+{
+    Udp_Framing_T_escaped = 0,
+    Udp_Framing_T_datagram = 1
+} Udp_Framing_T;
+
+typedef enum
+{
+    Thread_Policy_T_other = 0,
+    Thread_Policy_T_fifo = 1,
+    Thread_Policy_T_round_robin = 2
+} Thread_Policy_T;
+
+typedef asn1SccUint Thread_Conf_T_priority;
+typedef asn1SccUint Thread_Conf_T_stack_size;
+
+typedef struct
+{
+    int nCount;
+    asn1SccUint arr[64];
+} Thread_Conf_T_cpus;
+
+typedef struct
+{
+    Thread_Conf_T_priority priority;
+    Thread_Policy_T policy;
+    Thread_Conf_T_stack_size stack_size;
+    Thread_Conf_T_cpus cpus;
+
+    struct
+    {
+        unsigned int priority : 1;
+        unsigned int policy : 1;
+        unsigned int stack_size : 1;
+        unsigned int cpus : 1;
+    } exist;
+
+} Thread_Conf_T;
+
 typedef char Socket_IP_Conf_T_devname[21];
 typedef char Socket_IP_Conf_T_address[41];
 typedef flag Socket_IP_Conf_T_reuse_send_socket;
+typedef asn1SccUint Socket_IP_Conf_T_send_queue_size;
+typedef asn1SccUint Socket_IP_Conf_T_recv_batch_size;
+typedef asn1SccUint Socket_IP_Conf_T_recv_buffer_size;
+typedef asn1SccUint Socket_IP_Conf_T_max_datagram_size;
+typedef flag Socket_IP_Conf_T_udp_offload;
+typedef asn1SccUint Socket_IP_Conf_T_recv_workers;
+typedef flag Socket_IP_Conf_T_shared_event_loop;
 
 typedef struct
 {
@@ -51,11 +104,31 @@ typedef struct
     Version_T version;
     Port_T port;
     Socket_IP_Conf_T_reuse_send_socket reuse_send_socket;
+    Socket_IP_Conf_T_send_queue_size send_queue_size;
+    Send_Queue_Policy_T send_queue_policy;
+    Socket_IP_Conf_T_recv_batch_size recv_batch_size;
+    Socket_IP_Conf_T_recv_buffer_size recv_buffer_size;
+    Udp_Framing_T udp_framing;
+    Socket_IP_Conf_T_max_datagram_size max_datagram_size;
+    Socket_IP_Conf_T_udp_offload udp_offload;
+    Socket_IP_Conf_T_recv_workers recv_workers;
+    Socket_IP_Conf_T_shared_event_loop shared_event_loop;
+    Thread_Conf_T recv_thread;
 
     struct
     {
         unsigned int version : 1;
         unsigned int reuse_send_socket:1;
+        unsigned int send_queue_size : 1;
+        unsigned int send_queue_policy : 1;
+        unsigned int recv_batch_size : 1;
+        unsigned int recv_buffer_size : 1;
+        unsigned int udp_framing : 1;
+        unsigned int max_datagram_size : 1;
+        unsigned int udp_offload : 1;
+        unsigned int recv_workers : 1;
+        unsigned int shared_event_loop : 1;
+        unsigned int recv_thread : 1;
     } exist;
 
 } Socket_IP_Conf_T;
@@ -67,7 +140,19 @@ typedef enum
     Serial_CCSDS_Linux_Baudrate_T_b38400 = 2,
     Serial_CCSDS_Linux_Baudrate_T_b57600 = 3,
     Serial_CCSDS_Linux_Baudrate_T_b115200 = 4,
-    Serial_CCSDS_Linux_Baudrate_T_b230400 = 5
+    Serial_CCSDS_Linux_Baudrate_T_b230400 = 5,
+    Serial_CCSDS_Linux_Baudrate_T_b460800 = 6,
+    Serial_CCSDS_Linux_Baudrate_T_b500000 = 7,
+    Serial_CCSDS_Linux_Baudrate_T_b576000 = 8,
+    Serial_CCSDS_Linux_Baudrate_T_b921600 = 9,
+    Serial_CCSDS_Linux_Baudrate_T_b1000000 = 10,
+    Serial_CCSDS_Linux_Baudrate_T_b1152000 = 11,
+    Serial_CCSDS_Linux_Baudrate_T_b1500000 = 12,
+    Serial_CCSDS_Linux_Baudrate_T_b2000000 = 13,
+    Serial_CCSDS_Linux_Baudrate_T_b2500000 = 14,
+    Serial_CCSDS_Linux_Baudrate_T_b3000000 = 15,
+    Serial_CCSDS_Linux_Baudrate_T_b3500000 = 16,
+    Serial_CCSDS_Linux_Baudrate_T_b4000000 = 17
 } Serial_CCSDS_Linux_Baudrate_T;
 
 typedef enum
@@ -76,10 +161,33 @@ typedef enum
     Serial_CCSDS_Linux_Parity_T_odd = 1
 } Serial_CCSDS_Linux_Parity_T;
 
+typedef enum
+{
+    Serial_CCSDS_Linux_Send_Queue_Policy_T_block = 0,
+    Serial_CCSDS_Linux_Send_Queue_Policy_T_drop_oldest = 1,
+    Serial_CCSDS_Linux_Send_Queue_Policy_T_reject = 2
+} Serial_CCSDS_Linux_Send_Queue_Policy_T;
+
+typedef enum
+{
+    Serial_CCSDS_Linux_Flow_Control_T_none = 0,
+    Serial_CCSDS_Linux_Flow_Control_T_rts_cts = 1
+} Serial_CCSDS_Linux_Flow_Control_T;
+
 typedef char Serial_CCSDS_Linux_Conf_T_devname[25];
 typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_bits;
 
 typedef flag Serial_CCSDS_Linux_Conf_T_use_paritybit;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_send_queue_size;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_recv_min_bytes;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_recv_inter_byte_timeout;
+typedef flag Serial_CCSDS_Linux_Conf_T_low_latency;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_recv_idle_gap;
+typedef flag Serial_CCSDS_Linux_Conf_T_tx_drain;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_recv_pipeline_size;
+typedef flag Serial_CCSDS_Linux_Conf_T_compression;
+typedef flag Serial_CCSDS_Linux_Conf_T_shared_event_loop;
+typedef asn1SccUint Serial_CCSDS_Linux_Conf_T_custom_speed;
 
 typedef struct
 {
@@ -88,6 +196,19 @@ typedef struct
     Serial_CCSDS_Linux_Parity_T parity;
     Serial_CCSDS_Linux_Conf_T_bits bits;
     Serial_CCSDS_Linux_Conf_T_use_paritybit use_paritybit;
+    Serial_CCSDS_Linux_Conf_T_send_queue_size send_queue_size;
+    Serial_CCSDS_Linux_Send_Queue_Policy_T send_queue_policy;
+    Serial_CCSDS_Linux_Conf_T_recv_min_bytes recv_min_bytes;
+    Serial_CCSDS_Linux_Conf_T_recv_inter_byte_timeout recv_inter_byte_timeout;
+    Serial_CCSDS_Linux_Conf_T_low_latency low_latency;
+    Serial_CCSDS_Linux_Conf_T_recv_idle_gap recv_idle_gap;
+    Serial_CCSDS_Linux_Conf_T_tx_drain tx_drain;
+    Serial_CCSDS_Linux_Flow_Control_T flow_control;
+    Serial_CCSDS_Linux_Conf_T_recv_pipeline_size recv_pipeline_size;
+    Serial_CCSDS_Linux_Conf_T_compression compression;
+    Serial_CCSDS_Linux_Conf_T_shared_event_loop shared_event_loop;
+    Thread_Conf_T recv_thread;
+    Serial_CCSDS_Linux_Conf_T_custom_speed custom_speed;
 
     struct
     {
@@ -95,8 +216,92 @@ typedef struct
         unsigned int parity : 1;
         unsigned int bits : 1;
         unsigned int use_paritybit : 1;
+        unsigned int send_queue_size : 1;
+        unsigned int send_queue_policy : 1;
+        unsigned int recv_min_bytes : 1;
+        unsigned int recv_inter_byte_timeout : 1;
+        unsigned int low_latency : 1;
+        unsigned int recv_idle_gap : 1;
+        unsigned int tx_drain : 1;
+        unsigned int flow_control : 1;
+        unsigned int recv_pipeline_size : 1;
+        unsigned int compression : 1;
+        unsigned int shared_event_loop : 1;
+        unsigned int recv_thread : 1;
+        unsigned int custom_speed : 1;
     } exist;
 
 } Serial_CCSDS_Linux_Conf_T;
 
+typedef struct
+{
+    int nCount;
+    Serial_CCSDS_Linux_Conf_T arr[4];
+} Serial_CCSDS_Linux_Bond_Conf_T_ports;
+
+typedef asn1SccUint Serial_CCSDS_Linux_Bond_Conf_T_reorder_window;
+typedef asn1SccUint Serial_CCSDS_Linux_Bond_Conf_T_reorder_timeout;
+
+typedef struct
+{
+    Serial_CCSDS_Linux_Bond_Conf_T_ports ports;
+    Serial_CCSDS_Linux_Bond_Conf_T_reorder_window reorder_window;
+    Serial_CCSDS_Linux_Bond_Conf_T_reorder_timeout reorder_timeout;
+
+    struct
+    {
+        unsigned int reorder_window : 1;
+        unsigned int reorder_timeout : 1;
+    } exist;
+
+} Serial_CCSDS_Linux_Bond_Conf_T;
+
+typedef char Shared_Memory_Linux_Conf_T_name[41];
+typedef asn1SccUint Shared_Memory_Linux_Conf_T_ring_size;
+typedef asn1SccUint Shared_Memory_Linux_Conf_T_send_timeout;
+
+typedef struct
+{
+    Shared_Memory_Linux_Conf_T_name name;
+    Shared_Memory_Linux_Conf_T_ring_size ring_size;
+    Shared_Memory_Linux_Conf_T_send_timeout send_timeout;
+
+    struct
+    {
+        unsigned int ring_size : 1;
+        unsigned int send_timeout : 1;
+    } exist;
+
+} Shared_Memory_Linux_Conf_T;
+
+typedef enum
+{
+    Socket_Unix_Send_Queue_Policy_T_block = 0,
+    Socket_Unix_Send_Queue_Policy_T_drop_oldest = 1,
+    Socket_Unix_Send_Queue_Policy_T_reject = 2
+} Socket_Unix_Send_Queue_Policy_T;
+
+typedef char Socket_Unix_Conf_T_path[101];
+typedef flag Socket_Unix_Conf_T_reuse_send_socket;
+typedef asn1SccUint Socket_Unix_Conf_T_send_queue_size;
+typedef asn1SccUint Socket_Unix_Conf_T_fd_passing_threshold;
+
+typedef struct
+{
+    Socket_Unix_Conf_T_path path;
+    Socket_Unix_Conf_T_reuse_send_socket reuse_send_socket;
+    Socket_Unix_Conf_T_send_queue_size send_queue_size;
+    Socket_Unix_Send_Queue_Policy_T send_queue_policy;
+    Socket_Unix_Conf_T_fd_passing_threshold fd_passing_threshold;
+
+    struct
+    {
+        unsigned int reuse_send_socket : 1;
+        unsigned int send_queue_size : 1;
+        unsigned int send_queue_policy : 1;
+        unsigned int fd_passing_threshold : 1;
+    } exist;
+
+} Socket_Unix_Conf_T;
+
 #endif
@@ -69,10 +69,14 @@ main()
     taste::Thread sendThread2{ SEND_THREAD_PRIORITY2, SEND_THREAD_STACK_SIZE2 };
 
     Serial_CCSDS_Linux_Conf_T device1{
-        "/tmp/ttyVCOM0", Serial_CCSDS_Linux_Baudrate_T_b115200, Serial_CCSDS_Linux_Parity_T_odd, 8, 0, {}
+        "/tmp/ttyVCOM0", Serial_CCSDS_Linux_Baudrate_T_b115200, Serial_CCSDS_Linux_Parity_T_odd, 8, 0, 0,
+        Serial_CCSDS_Linux_Send_Queue_Policy_T_block, 0, 0, 0, 0, 0,
+        Serial_CCSDS_Linux_Flow_Control_T_none, 0, 0, 0, {}, 0, {}
     };
     Serial_CCSDS_Linux_Conf_T device2{
-        "/tmp/ttyVCOM1", Serial_CCSDS_Linux_Baudrate_T_b115200, Serial_CCSDS_Linux_Parity_T_odd, 8, 0, {}
+        "/tmp/ttyVCOM1", Serial_CCSDS_Linux_Baudrate_T_b115200, Serial_CCSDS_Linux_Parity_T_odd, 8, 0, 0,
+        Serial_CCSDS_Linux_Send_Queue_Policy_T_block, 0, 0, 0, 0, 0,
+        Serial_CCSDS_Linux_Flow_Control_T_none, 0, 0, 0, {}, 0, {}
     };
 
     serial1.driver_init(BUS_INVALID_ID, DEVICE_INVALID_ID, &device1, nullptr);
@@ -0,0 +1,298 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file     EscaperBenchmark.cc
+ * @brief    Compares taste::FastEscaper with Escaper: identical output and throughput.
+ *
+ * Output is compared for well-formed packets and for malformed received data: every escape
+ * sequence, empty frames, frames restarted by a start marker, frames overflowing the decoded
+ * packet buffer and random noise, fed whole and in small chunks. The benchmark fails
+ * if any output differs.
+ */
+
+#include <FastEscaper.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+extern "C"
+{
+#include <Escaper.h>
+}
+
+static constexpr size_t PACKET_SIZE = 4096;
+static constexpr size_t ENCODED_BUFFER_SIZE = 2 * PACKET_SIZE + 2;
+static constexpr size_t BYTE_VALUES = 256;
+static constexpr size_t RANDOM_PACKETS = 2000;
+static constexpr size_t BENCHMARK_PACKETS = 20000;
+static constexpr size_t CHUNK_SIZE = 61;
+
+typedef std::vector<std::vector<uint8_t>> packet_list;
+
+// Escaper passes decoded packets to a callback without context
+static packet_list* received_packets = nullptr;
+
+static void
+collect_packet(enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    received_packets->emplace_back(data, data + length);
+}
+
+static void
+count_packet(enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    (void)data;
+    (void)length;
+}
+
+static std::vector<uint8_t>
+encode_reference(const std::vector<uint8_t>& packet)
+{
+    static uint8_t encoded_buffer[ENCODED_BUFFER_SIZE];
+    Escaper escaper;
+    Escaper_init(&escaper, encoded_buffer, sizeof(encoded_buffer), nullptr, 0);
+    Escaper_start_encoder(&escaper);
+    std::vector<uint8_t> encoded;
+    size_t index = 0;
+    while(index < packet.size()) {
+        const size_t length = Escaper_encode_packet(&escaper, packet.data(), packet.size(), &index);
+        encoded.insert(encoded.end(), encoded_buffer, encoded_buffer + length);
+    }
+    return encoded;
+}
+
+static std::vector<uint8_t>
+encode_fast(const std::vector<uint8_t>& packet)
+{
+    static uint8_t encoded_buffer[ENCODED_BUFFER_SIZE];
+    static taste::FastEscaper escaper;
+    escaper.init(encoded_buffer, sizeof(encoded_buffer), nullptr, 0);
+    escaper.start_encoder();
+    std::vector<uint8_t> encoded;
+    size_t index = 0;
+    while(index < packet.size()) {
+        const size_t length = escaper.encode_packet(packet.data(), packet.size(), &index);
+        encoded.insert(encoded.end(), encoded_buffer, encoded_buffer + length);
+    }
+    return encoded;
+}
+
+static packet_list
+decode_reference(std::vector<uint8_t> stream, const size_t decoded_size)
+{
+    std::vector<uint8_t> decoded_buffer(decoded_size);
+    Escaper escaper;
+    Escaper_init(&escaper, nullptr, 0, decoded_buffer.data(), decoded_buffer.size());
+    Escaper_start_decoder(&escaper);
+    packet_list packets;
+    received_packets = &packets;
+    Escaper_decode_packet(&escaper, BUS_INVALID_ID, stream.data(), stream.size(), &collect_packet);
+    received_packets = nullptr;
+    return packets;
+}
+
+static packet_list
+decode_fast(std::vector<uint8_t> stream, const size_t decoded_size, const size_t chunk_size)
+{
+    std::vector<uint8_t> decoded_buffer(decoded_size);
+    taste::FastEscaper escaper;
+    escaper.init(nullptr, 0, decoded_buffer.data(), decoded_buffer.size());
+    escaper.start_decoder();
+    packet_list packets;
+    received_packets = &packets;
+    for(size_t position = 0; position < stream.size(); position += chunk_size) {
+        const size_t chunk = std::min(chunk_size, stream.size() - position);
+        escaper.decode_packet(BUS_INVALID_ID, &stream[position], chunk, &collect_packet);
+    }
+    received_packets = nullptr;
+    return packets;
+}
+
+static bool
+check_decoding(const char* const name, const std::vector<uint8_t>& stream, const size_t decoded_size)
+{
+    const packet_list expected = decode_reference(stream, decoded_size);
+    const bool identical = decode_fast(stream, decoded_size, stream.size()) == expected
+                           && decode_fast(stream, decoded_size, CHUNK_SIZE) == expected
+                           && decode_fast(stream, decoded_size, 1) == expected;
+    printf("decode %-36s %s\n", name, identical ? "identical" : "DIFFERENT");
+    return identical;
+}
+
+static bool
+check_malformed_input()
+{
+    // markers are learned from Escaper, as FastEscaper does
+    const uint8_t plain = static_cast<uint8_t>('a');
+    const std::vector<uint8_t> plain_frame = encode_reference({ plain });
+    const uint8_t start = plain_frame.front();
+    const uint8_t stop = plain_frame.back();
+    uint8_t escape = 0;
+    for(size_t value = 0; value < BYTE_VALUES; ++value) {
+        const std::vector<uint8_t> frame = encode_reference({ static_cast<uint8_t>(value) });
+        if(frame.size() > plain_frame.size()) {
+            escape = frame[1];
+            break;
+        }
+    }
+    bool identical = true;
+
+    std::vector<uint8_t> stream;
+    for(size_t value = 0; value < BYTE_VALUES; ++value) {
+        stream.insert(stream.end(), { start, plain, escape, static_cast<uint8_t>(value), plain, stop });
+        stream.insert(stream.end(), { start, plain, stop });
+    }
+    identical &= check_decoding("every escape sequence", stream, PACKET_SIZE);
+
+    stream = { start, stop, start, stop, stop, start, plain, stop };
+    identical &= check_decoding("empty frames", stream, PACKET_SIZE);
+
+    stream = { start, plain, plain, start, plain, stop, start, start, stop, plain, stop };
+    identical &= check_decoding("frames restarted by start marker", stream, PACKET_SIZE);
+
+    constexpr size_t SMALL_DECODED_SIZE = 16;
+    const std::vector<uint8_t> escaped_stop = encode_reference({ stop });
+    stream.clear();
+    for(size_t length = SMALL_DECODED_SIZE - 1; length <= SMALL_DECODED_SIZE + 1; ++length) {
+        stream.push_back(start);
+        stream.insert(stream.end(), length, plain);
+        stream.push_back(stop);
+        stream.push_back(start);
+        stream.insert(stream.end(), length, plain);
+        stream.insert(stream.end(), escaped_stop.begin() + 1, escaped_stop.end() - 1);
+        stream.insert(stream.end(), { plain, stop });
+        stream.insert(stream.end(), { start, plain, stop });
+    }
+    identical &= check_decoding("frames overflowing the buffer", stream, SMALL_DECODED_SIZE);
+
+    std::mt19937 generator(1);
+    stream.resize(1 << 20);
+    for(uint8_t& byte : stream) {
+        // markers are frequent, so most frames are short and many are malformed
+        const uint32_t random = static_cast<uint32_t>(generator());
+        byte = random % 8 == 0 ? (random & 8 ? start : (random & 16 ? stop : escape))
+                               : static_cast<uint8_t>(random >> 8);
+    }
+    identical &= check_decoding("random noise", stream, SMALL_DECODED_SIZE);
+    return identical;
+}
+
+static bool
+check_well_formed_packets()
+{
+    std::mt19937 generator(2);
+    std::vector<uint8_t> stream;
+    bool identical = true;
+    for(size_t i = 0; i < RANDOM_PACKETS; ++i) {
+        std::vector<uint8_t> packet(1 + generator() % PACKET_SIZE);
+        const bool random_content = i % 2 == 0;
+        for(uint8_t& byte : packet) {
+            byte = random_content ? static_cast<uint8_t>(generator()) : static_cast<uint8_t>('a');
+        }
+        const std::vector<uint8_t> encoded = encode_reference(packet);
+        identical &= encode_fast(packet) == encoded;
+        stream.insert(stream.end(), encoded.begin(), encoded.end());
+    }
+    printf("encode %-36s %s\n", "random packets", identical ? "identical" : "DIFFERENT");
+    identical &= check_decoding("random packets", stream, PACKET_SIZE);
+    return identical;
+}
+
+static double
+megabytes_per_second(const size_t bytes, const std::chrono::steady_clock::duration elapsed)
+{
+    return static_cast<double>(bytes) / std::chrono::duration<double>(elapsed).count() / 1e6;
+}
+
+static void
+measure(const char* const name, const std::vector<uint8_t>& packet)
+{
+    static uint8_t encoded_buffer[ENCODED_BUFFER_SIZE];
+    static uint8_t decoded_buffer[PACKET_SIZE];
+    const size_t bytes = BENCHMARK_PACKETS * packet.size();
+    std::vector<uint8_t> frame = encode_reference(packet);
+
+
+    Escaper reference;
+    Escaper_init(&reference, encoded_buffer, sizeof(encoded_buffer), decoded_buffer, sizeof(decoded_buffer));
+    taste::FastEscaper fast;
+    fast.init(encoded_buffer, sizeof(encoded_buffer), decoded_buffer, sizeof(decoded_buffer));
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < BENCHMARK_PACKETS; ++i) {
+        size_t index = 0;
+        Escaper_start_encoder(&reference);
+        Escaper_encode_packet(&reference, packet.data(), packet.size(), &index);
+    }
+    const double reference_encode = megabytes_per_second(bytes, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < BENCHMARK_PACKETS; ++i) {
+        size_t index = 0;
+        fast.start_encoder();
+        fast.encode_packet(packet.data(), packet.size(), &index);
+    }
+    const double fast_encode = megabytes_per_second(bytes, std::chrono::steady_clock::now() - start);
+
+    Escaper_start_decoder(&reference);
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < BENCHMARK_PACKETS; ++i) {
+        Escaper_decode_packet(&reference, BUS_INVALID_ID, frame.data(), frame.size(), &count_packet);
+    }
+    const double reference_decode = megabytes_per_second(bytes, std::chrono::steady_clock::now() - start);
+
+    fast.start_decoder();
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < BENCHMARK_PACKETS; ++i) {
+        fast.decode_packet(BUS_INVALID_ID, frame.data(), frame.size(), &count_packet);
+    }
+    const double fast_decode = megabytes_per_second(bytes, std::chrono::steady_clock::now() - start);
+
+    printf("%-16s %12.0f %12.0f %12.0f %12.0f\n", name, reference_encode, fast_encode, reference_decode, fast_decode);
+}
+
+int
+main()
+{
+    const bool identical = check_well_formed_packets() && check_malformed_input();
+
+    std::vector<uint8_t> packet(PACKET_SIZE);
+    printf("\n%-16s %12s %12s %12s %12s\n", "MB/s", "encode", "encode", "decode", "decode");
+    printf("%-16s %12s %12s %12s %12s\n", "packet content", "Escaper", "FastEscaper", "Escaper", "FastEscaper");
+    for(uint8_t& byte : packet) {
+        byte = static_cast<uint8_t>('a');
+    }
+    measure("no escapes", packet);
+    std::mt19937 generator(3);
+    for(uint8_t& byte : packet) {
+        byte = static_cast<uint8_t>(generator());
+    }
+    measure("random bytes", packet);
+
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file     SendSyscallsBenchmark.cc
+ * @brief    Counts send syscalls per packet sent by linux_ip_socket.
+ *
+ * The old transmit path, which pushed every 1 KiB encoder chunk with its own send(),
+ * is reproduced with the Escaper and compared with the driver's whole-packet path.
+ * Send functions are interposed by this executable, so no tracer is needed.
+ */
+
+#include "linux_ip_socket/linux_ip_socket.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include <Escaper.h>
+}
+
+static constexpr uint16_t RECEIVER_PORT = 5490;
+static constexpr uint16_t DRIVER_PORT = 5491;
+static constexpr size_t LEGACY_ENCODED_PACKET_BUFFER_SIZE = 1024;
+static constexpr size_t PACKETS_PER_SIZE = 1000;
+static constexpr size_t PACKET_SIZES[] = { 200, 1024, 4096, BROKER_BUFFER_SIZE };
+
+void* bus_to_driver_private_data[1];
+void* bus_to_driver_send_function[1];
+void* interface_to_deliver_function[1];
+
+static std::atomic<uint64_t> send_syscalls{ 0 };
+static std::atomic<int> accepted_connections{ 0 };
+
+static uint8_t legacy_encoded_packet_buffer[LEGACY_ENCODED_PACKET_BUFFER_SIZE];
+static uint8_t legacy_decoded_packet_buffer[BROKER_BUFFER_SIZE];
+
+// Interposed send functions, each counts itself and enters the kernel directly
+extern "C" ssize_t
+send(int fd, const void* buffer, size_t length, int flags)
+{
+    send_syscalls.fetch_add(1, std::memory_order_relaxed);
+    return syscall(SYS_sendto, fd, buffer, length, flags, nullptr, 0);
+}
+
+extern "C" ssize_t
+sendto(int fd, const void* buffer, size_t length, int flags, const struct sockaddr* address, socklen_t address_length)
+{
+    send_syscalls.fetch_add(1, std::memory_order_relaxed);
+    return syscall(SYS_sendto, fd, buffer, length, flags, address, address_length);
+}
+
+extern "C" ssize_t
+sendmsg(int fd, const struct msghdr* message, int flags)
+{
+    send_syscalls.fetch_add(1, std::memory_order_relaxed);
+    return syscall(SYS_sendmsg, fd, message, flags);
+}
+
+extern "C" ssize_t
+writev(int fd, const struct iovec* vectors, int count)
+{
+    send_syscalls.fetch_add(1, std::memory_order_relaxed);
+    return syscall(SYS_writev, fd, vectors, count);
+}
+
+static int
+open_receiver()
+{
+    const int listen_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    const int reuse = 1;
+    setsockopt(listen_sockfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(RECEIVER_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(listen_sockfd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+       || listen(listen_sockfd, 4) != 0) {
+        perror("Cannot listen on receiver port");
+        exit(EXIT_FAILURE);
+    }
+    return listen_sockfd;
+}
+
+static void
+drain_connections(const int listen_sockfd)
+{
+    while(true) {
+        const int sockfd = accept(listen_sockfd, nullptr, nullptr);
+        if(sockfd < 0) {
+            return;
+        }
+        accepted_connections.fetch_add(1);
+        std::thread([sockfd] {
+            static thread_local uint8_t buffer[65536];
+            while(recv(sockfd, buffer, sizeof(buffer), 0) > 0) {
+            }
+            close(sockfd);
+        }).detach();
+    }
+}
+
+static int
+connect_to_receiver()
+{
+    const int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(RECEIVER_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(connect(sockfd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        perror("Cannot connect to receiver");
+        exit(EXIT_FAILURE);
+    }
+    return sockfd;
+}
+
+// transmit path before whole-packet encoding: one send() per encoder chunk
+static void
+legacy_send(Escaper* const escaper, const int sockfd, const uint8_t* const data, const size_t length)
+{
+    size_t index = 0;
+    Escaper_start_encoder(escaper);
+    while(index < length) {
+        const size_t packet_length = Escaper_encode_packet(escaper, data, length, &index);
+        size_t bytes_sent = 0;
+        while(bytes_sent < packet_length) {
+            const ssize_t send_result =
+                    send(sockfd, legacy_encoded_packet_buffer + bytes_sent, packet_length - bytes_sent, MSG_NOSIGNAL);
+            if(send_result < 0) {
+                perror("send");
+                exit(EXIT_FAILURE);
+            }
+            bytes_sent += static_cast<size_t>(send_result);
+        }
+    }
+}
+
+int
+main()
+{
+    const int listen_sockfd = open_receiver();
+    std::thread(drain_connections, listen_sockfd).detach();
+
+    static Socket_IP_Conf_T device;
+    static Socket_IP_Conf_T remote;
+    strcpy(device.devname, "lo");
+    strcpy(device.address, "127.0.0.1");
+    device.port = DRIVER_PORT;
+    device.reuse_send_socket = true;
+    device.exist.reuse_send_socket = true;
+    remote = device;
+    remote.port = RECEIVER_PORT;
+
+    static linux_ip_socket_private_data driver;
+    driver.driver_init(BUS_INVALID_ID, DEVICE_INVALID_ID, &device, &remote);
+
+    static uint8_t packet[BROKER_BUFFER_SIZE];
+    for(size_t i = 0; i < sizeof(packet); ++i) {
+        // every value occurs, so start, stop and escape markers are escaped as well
+        packet[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    Escaper legacy_escaper;
+    Escaper_init(&legacy_escaper,
+                 legacy_encoded_packet_buffer,
+                 sizeof(legacy_encoded_packet_buffer),
+                 legacy_decoded_packet_buffer,
+                 sizeof(legacy_decoded_packet_buffer));
+    const int legacy_sockfd = connect_to_receiver();
+
+    // the driver's connection manager connects in the background, after the legacy connection
+    while(accepted_connections.load() < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    printf("packet size  send syscalls per packet\n");
+    printf("             before    after\n");
+    for(const size_t size : PACKET_SIZES) {
+        send_syscalls.store(0);
+        for(size_t i = 0; i < PACKETS_PER_SIZE; ++i) {
+            legacy_send(&legacy_escaper, legacy_sockfd, packet, size);
+        }
+        const double before = static_cast<double>(send_syscalls.load()) / PACKETS_PER_SIZE;
+
+        send_syscalls.store(0);
+        for(size_t i = 0; i < PACKETS_PER_SIZE; ++i) {
+            driver.driver_send(packet, size);
+        }
+        const double after = static_cast<double>(send_syscalls.load()) / PACKETS_PER_SIZE;
+
+        printf("%11zu  %6.2f  %7.2f\n", size, before, after);
+    }
+
+    fflush(stdout);
+    // driver threads never return
+    _exit(EXIT_SUCCESS);
+}
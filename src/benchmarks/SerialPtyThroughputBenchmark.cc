@@ -0,0 +1,186 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file     SerialPtyThroughputBenchmark.cc
+ * @brief    Throughput of linux_serial_ccsds over a pseudo terminal pair.
+ *
+ * The driver opens the slave end with a custom baudrate, which is set through termios2/BOTHER.
+ * A pty does not limit its rate, so the result is the driver's own ceiling: packets sent
+ * by the driver are read from the master end, and frames written to the master end
+ * are decoded by the driver and counted by a sink, which replaces the Broker.
+ */
+
+#include "linux_serial_ccsds/linux_serial_ccsds.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <pty.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include <Escaper.h>
+}
+
+static constexpr uint32_t CUSTOM_BAUDRATE = 4000000;
+static constexpr size_t PACKET_SIZE = 1024;
+static constexpr size_t PACKET_COUNT = 20000;
+static constexpr int SETTLE_TIME_MS = 200;
+static constexpr int IDLE_TIMEOUT_MS = 500;
+
+static std::atomic<uint64_t> delivered_packets{ 0 };
+static std::atomic<uint64_t> transmitted_bytes{ 0 };
+
+void
+Broker_receive_packet(enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    (void)data;
+    (void)length;
+    delivered_packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void
+read_master(const int master_fd)
+{
+    static uint8_t buffer[65536];
+    while(true) {
+        const ssize_t read_result = read(master_fd, buffer, sizeof(buffer));
+        if(read_result <= 0) {
+            return;
+        }
+        transmitted_bytes.fetch_add(static_cast<uint64_t>(read_result), std::memory_order_relaxed);
+    }
+}
+
+// returns the time of the last change of counter, once it did not change for IDLE_TIMEOUT_MS
+static std::chrono::steady_clock::time_point
+wait_until_idle(const std::atomic<uint64_t>& counter, std::chrono::steady_clock::time_point last_change)
+{
+    uint64_t last_value = counter.load();
+    while(std::chrono::steady_clock::now() - last_change < std::chrono::milliseconds(IDLE_TIMEOUT_MS)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const uint64_t value = counter.load();
+        if(value != last_value) {
+            last_value = value;
+            last_change = std::chrono::steady_clock::now();
+        }
+    }
+    return last_change;
+}
+
+static void
+print_result(const char* const direction,
+             const uint64_t packets,
+             const uint64_t bytes,
+             const std::chrono::steady_clock::duration elapsed)
+{
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    printf("%-9s  %11lu/%zu  %10.1f  %22.1f\n",
+           direction,
+           static_cast<unsigned long>(packets),
+           PACKET_COUNT,
+           static_cast<double>(bytes) / seconds / 1e6,
+           static_cast<double>(bytes) * 10.0 / seconds / 1e6);
+}
+
+int
+main()
+{
+    int master_fd = -1;
+    int slave_fd = -1;
+    char slave_name[64];
+    if(openpty(&master_fd, &slave_fd, slave_name, nullptr, nullptr) != 0) {
+        perror("openpty");
+        return EXIT_FAILURE;
+    }
+
+    static Serial_CCSDS_Linux_Conf_T device;
+    if(strlen(slave_name) >= sizeof(device.devname)) {
+        fprintf(stderr, "Pty name %s is too long\n", slave_name);
+        return EXIT_FAILURE;
+    }
+    memcpy(device.devname, slave_name, strlen(slave_name) + 1);
+    device.bits = 8;
+    device.exist.bits = true;
+    device.custom_speed = CUSTOM_BAUDRATE;
+    device.exist.custom_speed = true;
+
+    static linux_serial_ccsds_private_data driver;
+    driver.driver_init(BUS_INVALID_ID, DEVICE_INVALID_ID, &device, nullptr);
+    std::thread(read_master, master_fd).detach();
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_TIME_MS));
+
+    static uint8_t packet[PACKET_SIZE];
+    for(size_t i = 0; i < sizeof(packet); ++i) {
+        packet[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    printf("baudrate %u set on %s\n", CUSTOM_BAUDRATE, slave_name);
+    printf("direction            packets        MB/s  equivalent Mbaud (8N1)\n");
+
+    // driver to master: the escaped stream is counted as it leaves the pty
+    transmitted_bytes.store(0);
+    const auto transmit_start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < PACKET_COUNT; ++i) {
+        driver.driver_send(packet, sizeof(packet));
+    }
+    const auto transmit_end = wait_until_idle(transmitted_bytes, std::chrono::steady_clock::now());
+    print_result("transmit", PACKET_COUNT, transmitted_bytes.load(), transmit_end - transmit_start);
+
+    // master to driver: frames are escaped once up front, so only the driver's decoding is measured
+    static uint8_t frame[2 * PACKET_SIZE + 2];
+    static uint8_t decoded_packet_buffer[PACKET_SIZE];
+    Escaper escaper;
+    Escaper_init(&escaper, frame, sizeof(frame), decoded_packet_buffer, sizeof(decoded_packet_buffer));
+    Escaper_start_encoder(&escaper);
+    size_t index = 0;
+    const size_t frame_length = Escaper_encode_packet(&escaper, packet, sizeof(packet), &index);
+
+    delivered_packets.store(0);
+    const auto receive_start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < PACKET_COUNT; ++i) {
+        size_t written = 0;
+        while(written < frame_length) {
+            const ssize_t write_result = write(master_fd, frame + written, frame_length - written);
+            if(write_result < 0) {
+                perror("write");
+                return EXIT_FAILURE;
+            }
+            written += static_cast<size_t>(write_result);
+        }
+    }
+    const auto receive_end = wait_until_idle(delivered_packets, std::chrono::steady_clock::now());
+    print_result("receive",
+                 delivered_packets.load(),
+                 delivered_packets.load() * frame_length,
+                 receive_end - receive_start);
+
+    fflush(stdout);
+    // driver threads never return
+    _exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,141 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file     UdpOffloadBenchmark.cc
+ * @brief    Loopback throughput of linux_udp with and without udp-offload.
+ *
+ * Two driver instances exchange packets of BROKER_BUFFER_SIZE bytes with datagram framing,
+ * so every packet is sent in fragments of max-datagram-size. The Broker is replaced
+ * by a sink which counts delivered packets.
+ */
+
+#include "linux_udp/linux_udp.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <unistd.h>
+
+static constexpr uint16_t BASE_PORT = 5500;
+static constexpr size_t PACKET_SIZE = BROKER_BUFFER_SIZE;
+static constexpr size_t PACKET_COUNT = 20000;
+static constexpr unsigned int RECV_BATCH_SIZE = 64;
+static constexpr int SETTLE_TIME_MS = 200;
+static constexpr int IDLE_TIMEOUT_MS = 500;
+
+static std::atomic<uint64_t> delivered_packets{ 0 };
+static std::atomic<uint64_t> delivered_bytes{ 0 };
+
+void
+Broker_receive_packet(enum SystemBus bus_id, uint8_t* const data, const size_t length)
+{
+    (void)bus_id;
+    (void)data;
+    delivered_packets.fetch_add(1, std::memory_order_relaxed);
+    delivered_bytes.fetch_add(length, std::memory_order_relaxed);
+}
+
+static void
+fill_configuration(Socket_IP_Conf_T* const configuration, const uint16_t port, const bool offload)
+{
+    memset(configuration, 0, sizeof(Socket_IP_Conf_T));
+    strcpy(configuration->devname, "lo");
+    strcpy(configuration->address, "127.0.0.1");
+    configuration->port = port;
+    configuration->udp_framing = Udp_Framing_T_datagram;
+    configuration->exist.udp_framing = true;
+    configuration->recv_batch_size = RECV_BATCH_SIZE;
+    configuration->exist.recv_batch_size = true;
+    configuration->udp_offload = offload;
+    configuration->exist.udp_offload = true;
+}
+
+static void
+run(const char* const name, const uint16_t port, const bool offload)
+{
+    // drivers are never stopped, so every run uses its own pair
+    static Socket_IP_Conf_T configurations[2][2];
+    static linux_udp_private_data drivers[2][2];
+    const size_t run_index = offload ? 1 : 0;
+    Socket_IP_Conf_T* const receiver_configuration = &configurations[run_index][0];
+    Socket_IP_Conf_T* const sender_configuration = &configurations[run_index][1];
+    fill_configuration(receiver_configuration, port, offload);
+    fill_configuration(sender_configuration, static_cast<uint16_t>(port + 1), offload);
+
+    drivers[run_index][0].driver_init(BUS_INVALID_ID, DEVICE_INVALID_ID, receiver_configuration, nullptr);
+    drivers[run_index][1].driver_init(
+            BUS_INVALID_ID, DEVICE_INVALID_ID, sender_configuration, receiver_configuration);
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_TIME_MS));
+
+    static uint8_t packet[PACKET_SIZE];
+    for(size_t i = 0; i < sizeof(packet); ++i) {
+        packet[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    delivered_packets.store(0);
+    delivered_bytes.store(0);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < PACKET_COUNT; ++i) {
+        drivers[run_index][1].driver_send(packet, sizeof(packet));
+    }
+    const auto sent = std::chrono::steady_clock::now();
+
+    // wait until the receiver is idle, then take the time of the last delivery
+    auto last_delivery = sent;
+    uint64_t last_count = delivered_packets.load();
+    while(std::chrono::steady_clock::now() - last_delivery < std::chrono::milliseconds(IDLE_TIMEOUT_MS)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const uint64_t count = delivered_packets.load();
+        if(count != last_count) {
+            last_count = count;
+            last_delivery = std::chrono::steady_clock::now();
+        }
+    }
+
+    const double send_seconds = std::chrono::duration<double>(sent - start).count();
+    const double receive_seconds = std::chrono::duration<double>(last_delivery - start).count();
+    const double sent_megabytes = static_cast<double>(PACKET_COUNT * PACKET_SIZE) / 1e6;
+    const double delivered_megabytes = static_cast<double>(delivered_bytes.load()) / 1e6;
+    printf("%-12s  %9.1f  %12.1f  %9lu/%zu\n",
+           name,
+           sent_megabytes / send_seconds,
+           delivered_megabytes / receive_seconds,
+           static_cast<unsigned long>(delivered_packets.load()),
+           PACKET_COUNT);
+}
+
+int
+main()
+{
+    printf("mode          sent MB/s  delivered MB/s  delivered packets\n");
+    run("sendmmsg", BASE_PORT, false);
+    run("udp-offload", static_cast<uint16_t>(BASE_PORT + 2), true);
+
+    fflush(stdout);
+    // driver threads never return
+    _exit(EXIT_SUCCESS);
+}
@@ -22,30 +22,43 @@
 
 #include "linux_ip_socket.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <errno.h>
-#include <poll.h>
 #include <unistd.h>
 
 linux_ip_socket_private_data::linux_ip_socket_private_data()
-    : m_send_sockfd(INVALID_SOCKET_ID)
+    : m_listen_sockfd(INVALID_SOCKET_ID)
+    , m_epollfd(INVALID_SOCKET_ID)
+    , m_send_sockfd(INVALID_SOCKET_ID)
     , m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_connection_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_send_queue(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_remote_address_length(0)
+    , m_remote_address_family(AF_UNSPEC)
+    , m_shared_event_loop(false)
 {
-    Escaper_init(&escaper,
-                 m_encoded_packet_buffer,
-                 ENCODED_PACKET_BUFFER_SIZE,
-                 m_decoded_packet_buffer,
-                 DECODED_PACKET_BUFFER_SIZE);
+    // the encoder is used only for sending, received data is decoded per connection
+    m_encoder.escaper.init(m_encoder.encoded_packet_buffer, ENCODED_PACKET_BUFFER_SIZE, nullptr, 0);
+
+    for(connection& conn : m_connections) {
+        conn.driver = this;
+        conn.sockfd = INVALID_SOCKET_ID;
+        conn.escaper.init(nullptr, 0, conn.decoded_packet_buffer, DECODED_PACKET_BUFFER_SIZE);
+    }
 }
 
 void
@@ -58,36 +71,54 @@ linux_ip_socket_private_data::driver_init(const SystemBus bus_id,
     m_ip_device_id = device_id;
     m_ip_device_configuration = device_configuration;
     m_ip_remote_device_configuration = remote_device_configuration;
-    m_thread.start(&taste::LinuxIpSocketPoll, this);
+    m_delivery.init(bus_id);
+
+    m_shared_event_loop = device_configuration->exist.shared_event_loop && device_configuration->shared_event_loop;
+
+    resolve_remote_address();
+    init_send_queue();
+    init_thread_settings();
+
+    if(m_shared_event_loop) {
+        prepare_listen_socket();
+        taste::EventLoop::shared().add(m_listen_sockfd, &linux_ip_socket_private_data::listen_ready, this);
+    } else {
+        m_thread.start(&taste::LinuxIpSocketPoll, this);
+    }
+    if(m_ip_device_configuration->exist.reuse_send_socket && m_ip_device_configuration->reuse_send_socket) {
+        m_connection_thread.start(&taste::LinuxIpSocketManageConnection, this);
+    }
 }
 
 void
 linux_ip_socket_private_data::driver_poll()
 {
     prepare_listen_socket();
+    prepare_epoll();
 
-    // only one listen socket
-    const int listen_descriptors_table_size = 1;
-    struct pollfd listen_descriptors_table[listen_descriptors_table_size];
-    listen_descriptors_table[0].fd = m_listen_sockfd;
-    listen_descriptors_table[0].events = POLLIN;
-
-    // only one active connection
-    const int connected_descriptors_table_size = 1;
-    struct pollfd connected_descriptors_table[connected_descriptors_table_size];
+    struct epoll_event events[EPOLL_MAX_EVENTS];
 
     while(true) {
-        // wait for data on listen without timeout
-        const int poll_result = ::poll(listen_descriptors_table, listen_descriptors_table_size, POLL_NO_TIMEOUT);
-        if(poll_result == POLL_ERROR) {
-            std::cerr << "poll() returned an error: " << strerror(errno) << std::endl;
+        // wait for new connections or data without timeout
+        const int epoll_result = epoll_wait(m_epollfd, events, EPOLL_MAX_EVENTS, POLL_NO_TIMEOUT);
+        if(epoll_result == EPOLL_ERROR) {
+            if(errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait() returned an error: " << strerror(errno) << std::endl;
             std::cerr << "aborting." << std::endl;
             abort();
         }
 
-        if(listen_descriptors_table[0].revents & POLLIN) {
-            if(accept_connection(connected_descriptors_table)) {
-                handle_connection(connected_descriptors_table);
+        for(int i = 0; i < epoll_result; ++i) {
+            // listen socket is registered without connection
+            connection* const conn = static_cast<connection*>(events[i].data.ptr);
+            if(conn == nullptr) {
+                accept_connection();
+            } else if(conn->sockfd != INVALID_SOCKET_ID) {
+                if(!read_data_or_disconnect(conn)) {
+                    close_connection(conn);
+                }
             }
         }
     }
@@ -95,28 +126,80 @@ linux_ip_socket_private_data::driver_poll()
 
 void
 linux_ip_socket_private_data::driver_send(const uint8_t* const data, const size_t length)
+{
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
+
+void
+linux_ip_socket_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    if(m_send_queue.is_enabled()) {
+        const taste::SendQueuePushResult result = m_send_queue.push(fragments, count);
+        if(result == taste::SendQueuePushResult::Full) {
+            std::cerr << "Send queue is full, dropping packet" << std::endl;
+        } else if(result == taste::SendQueuePushResult::TooLarge) {
+            std::cerr << "Packet larger than send queue slot, dropping it" << std::endl;
+        }
+    } else {
+        transmit(fragments, count);
+    }
+}
+
+taste::SendQueueStatistics
+linux_ip_socket_private_data::driver_send_queue_statistics() const
+{
+    return m_send_queue.statistics();
+}
+
+void
+linux_ip_socket_private_data::transmit_queued(void* private_data, const uint8_t* data, size_t length)
+{
+    linux_ip_socket_private_data* self = reinterpret_cast<linux_ip_socket_private_data*>(private_data);
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    self->transmit(&fragment, 1);
+}
+
+void
+linux_ip_socket_private_data::transmit(const struct iovec* const fragments, const size_t count)
 {
     if(m_ip_device_configuration->exist.reuse_send_socket && m_ip_device_configuration->reuse_send_socket) {
-        driver_send_reuse_connection(data, length);
+        driver_send_reuse_connection(fragments, count);
     } else {
-        driver_send_new_connection(data, length);
+        driver_send_new_connection(fragments, count);
     }
 }
 
 void
 linux_ip_socket_private_data::driver_send_new_connection(const uint8_t* const data, const size_t length)
 {
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send_new_connection(&fragment, 1);
+}
+
+void
+linux_ip_socket_private_data::driver_send_new_connection(const struct iovec* const fragments, const size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_encoder.mutex);
+
     const int sockfd = connect_to_remote_driver();
     if(sockfd == INVALID_SOCKET_ID) {
         return;
     }
 
+    const size_t length = taste::FragmentsLength(fragments, count);
     size_t index = 0;
 
-    Escaper_start_encoder(&escaper);
+    m_encoder.escaper.start_encoder();
     while(index < length) {
-        size_t packet_length = Escaper_encode_packet(&escaper, data, length, &index);
-        if(!send_packet(sockfd, m_encoded_packet_buffer, packet_length)) {
+        size_t packet_length = m_encoder.escaper.encode_fragments(fragments, count, &index);
+        if(!send_packet(sockfd, m_encoder.encoded_packet_buffer, packet_length)) {
             break;
         }
     }
@@ -127,27 +210,112 @@ linux_ip_socket_private_data::driver_send_new_connection(const uint8_t* const da
 void
 linux_ip_socket_private_data::driver_send_reuse_connection(const uint8_t* const data, const size_t length)
 {
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send_reuse_connection(&fragment, 1);
+}
+
+void
+linux_ip_socket_private_data::driver_send_reuse_connection(const struct iovec* const fragments, const size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_encoder.mutex);
+
     if(m_send_sockfd == INVALID_SOCKET_ID) {
-        m_send_sockfd = connect_to_remote_driver();
-        if(m_send_sockfd == INVALID_SOCKET_ID) {
-            return;
-        }
+        // only the connection manager connects, so the sender never waits for the handshake
+        std::cerr << "Not connected to remote driver, dropping packet" << std::endl;
+        m_send_disconnected.notify_one();
+        return;
     }
 
+    const size_t length = taste::FragmentsLength(fragments, count);
     size_t index = 0;
 
-    Escaper_start_encoder(&escaper);
+    m_encoder.escaper.start_encoder();
 
     while(index < length) {
-        size_t packet_length = Escaper_encode_packet(&escaper, data, length, &index);
-        if(!send_packet(m_send_sockfd, m_encoded_packet_buffer, packet_length)) {
-            close(m_send_sockfd);
-            m_send_sockfd = INVALID_SOCKET_ID;
+        size_t packet_length = m_encoder.escaper.encode_fragments(fragments, count, &index);
+        if(!send_packet(m_send_sockfd, m_encoder.encoded_packet_buffer, packet_length)) {
+            drop_send_connection();
             break;
         }
     }
 }
 
+void
+linux_ip_socket_private_data::driver_manage_connection()
+{
+    int backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(m_encoder.mutex);
+            m_send_disconnected.wait(lock, [this] { return m_send_sockfd == INVALID_SOCKET_ID; });
+        }
+
+        // connect outside of the lock, senders drop packets in the meantime
+        const int sockfd = connect_to_remote_driver();
+        if(sockfd == INVALID_SOCKET_ID) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+            backoff_ms = std::min(backoff_ms * 2, RECONNECT_BACKOFF_MAX_MS);
+            continue;
+        }
+        backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+
+        std::lock_guard<std::mutex> lock(m_encoder.mutex);
+        m_send_sockfd = sockfd;
+    }
+}
+
+void
+linux_ip_socket_private_data::drop_send_connection()
+{
+    // called with m_encoder.mutex locked
+    close(m_send_sockfd);
+    m_send_sockfd = INVALID_SOCKET_ID;
+    m_send_disconnected.notify_one();
+}
+
+void
+linux_ip_socket_private_data::init_send_queue()
+{
+    if(!m_ip_device_configuration->exist.send_queue_size || m_ip_device_configuration->send_queue_size == 0) {
+        return;
+    }
+
+    taste::SendQueuePolicy policy = taste::SendQueuePolicy::Block;
+    if(m_ip_device_configuration->exist.send_queue_policy) {
+        switch(m_ip_device_configuration->send_queue_policy) {
+            case Send_Queue_Policy_T_block:
+                policy = taste::SendQueuePolicy::Block;
+                break;
+            case Send_Queue_Policy_T_drop_oldest:
+                policy = taste::SendQueuePolicy::DropOldest;
+                break;
+            case Send_Queue_Policy_T_reject:
+                policy = taste::SendQueuePolicy::Reject;
+                break;
+            default:
+                std::cerr << "Not supported send queue policy, defaulting to block" << std::endl;
+        }
+    }
+
+    m_send_queue.init(m_ip_device_configuration->send_queue_size, policy, DECODED_PACKET_BUFFER_SIZE);
+    m_send_queue.start(&linux_ip_socket_private_data::transmit_queued, this);
+}
+
+void
+linux_ip_socket_private_data::init_thread_settings()
+{
+    if(!m_ip_device_configuration->exist.recv_thread) {
+        return;
+    }
+
+    taste::ThreadSettings settings = m_thread.settings();
+    taste::ThreadSettingsFromConfig(m_ip_device_configuration->recv_thread, &settings);
+    m_thread.configure(settings);
+}
+
 void
 linux_ip_socket_private_data::find_addresses(addrinfo** target, const char* address, const unsigned int port)
 {
@@ -183,9 +351,13 @@ linux_ip_socket_private_data::send_packet(const int sockfd, const uint8_t* buffe
     return true;
 }
 
-int
-linux_ip_socket_private_data::connect_to_remote_driver()
+void
+linux_ip_socket_private_data::resolve_remote_address()
 {
+    if(m_ip_remote_device_configuration == nullptr) {
+        return;
+    }
+
     addrinfo* address_array = nullptr;
 
     find_addresses(&address_array, m_ip_remote_device_configuration->address, m_ip_remote_device_configuration->port);
@@ -195,26 +367,39 @@ linux_ip_socket_private_data::connect_to_remote_driver()
     if(connect_address == nullptr) {
         std::cerr << "Cannot find remote address." << std::endl;
         freeaddrinfo(address_array);
+        return;
+    }
+
+    memcpy(&m_remote_address, connect_address->ai_addr, connect_address->ai_addrlen);
+    m_remote_address_length = connect_address->ai_addrlen;
+    m_remote_address_family = connect_address->ai_family;
+
+    freeaddrinfo(address_array);
+}
+
+int
+linux_ip_socket_private_data::connect_to_remote_driver()
+{
+    if(m_remote_address_family == AF_UNSPEC) {
+        std::cerr << "Remote address is not resolved." << std::endl;
         return INVALID_SOCKET_ID;
     }
 
-    const int sockfd = socket(connect_address->ai_family, connect_address->ai_socktype, connect_address->ai_protocol);
-    int enabled = 1;
-    setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(int));
+    const int sockfd = socket(m_remote_address_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if(sockfd == INVALID_SOCKET_ID) {
         std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
-        freeaddrinfo(address_array);
         return INVALID_SOCKET_ID;
     }
-    const int connect_result = connect(sockfd, connect_address->ai_addr, connect_address->ai_addrlen);
+    int enabled = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(int));
+    const int connect_result =
+            connect(sockfd, reinterpret_cast<const sockaddr*>(&m_remote_address), m_remote_address_length);
     if(connect_result == CONNECT_ERROR) {
         std::cerr << "connect() returned an error: " << strerror(errno) << std::endl;
-        freeaddrinfo(address_array);
+        close(sockfd);
         return INVALID_SOCKET_ID;
     }
 
-    freeaddrinfo(address_array);
-
     return sockfd;
 }
 
@@ -226,7 +411,8 @@ linux_ip_socket_private_data::prepare_listen_socket()
 
     addrinfo* listen_address = nullptr;
     for(listen_address = address_array; listen_address != nullptr; listen_address = listen_address->ai_next) {
-        m_listen_sockfd = socket(listen_address->ai_family, listen_address->ai_socktype, listen_address->ai_protocol);
+        m_listen_sockfd = socket(
+                listen_address->ai_family, listen_address->ai_socktype | SOCK_NONBLOCK, listen_address->ai_protocol);
         int enabled = 1;
         setsockopt(m_listen_sockfd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(int));
         if(m_listen_sockfd == INVALID_SOCKET_ID) {
@@ -257,65 +443,122 @@ linux_ip_socket_private_data::prepare_listen_socket()
     }
 }
 
-bool
-linux_ip_socket_private_data::accept_connection(pollfd* table)
+void
+linux_ip_socket_private_data::prepare_epoll()
+{
+    m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(m_epollfd == INVALID_SOCKET_ID) {
+        std::cerr << "epoll_create1() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if(epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_listen_sockfd, &event) == EPOLL_ERROR) {
+        std::cerr << "Cannot watch listen socket: " << strerror(errno) << std::endl;
+        abort();
+    }
+}
+
+void
+linux_ip_socket_private_data::listen_ready(void* private_data, uint32_t events)
+{
+    (void)events;
+    linux_ip_socket_private_data* self = reinterpret_cast<linux_ip_socket_private_data*>(private_data);
+    self->accept_connection();
+}
+
+void
+linux_ip_socket_private_data::connection_ready(void* ready_connection, uint32_t events)
+{
+    (void)events;
+    connection* const conn = static_cast<connection*>(ready_connection);
+    if(!conn->driver->read_data_or_disconnect(conn)) {
+        conn->driver->close_connection(conn);
+    }
+}
+
+void
+linux_ip_socket_private_data::accept_connection()
 {
     sockaddr_storage remote_addr;
     socklen_t remote_addr_size = sizeof(sockaddr_storage);
-    const int new_sockfd = accept(m_listen_sockfd, (struct sockaddr*)&remote_addr, &remote_addr_size);
+    // accepted sockets are non-blocking, so a stale event can never stall the loop
+    const int new_sockfd =
+            accept4(m_listen_sockfd, (struct sockaddr*)&remote_addr, &remote_addr_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(new_sockfd == INVALID_SOCKET_ID) {
+        if(errno != EAGAIN) {
+            std::cerr << "accept() returned an error: " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
     int enabled = 1;
     setsockopt(new_sockfd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(int));
-    if(new_sockfd == INVALID_SOCKET_ID) {
-        std::cerr << "accept() returned an error: " << std::strerror(errno) << std::endl;
-        table[0].fd = 0;
-        table[0].events = 0;
-        return false;
-    } else {
-        table[0].fd = new_sockfd;
-        table[0].events = POLLIN;
-        return true;
+
+    connection* conn = nullptr;
+    for(connection& candidate : m_connections) {
+        if(candidate.sockfd == INVALID_SOCKET_ID) {
+            conn = &candidate;
+            break;
+        }
+    }
+    if(conn == nullptr) {
+        std::cerr << "Too many connections, rejecting new one" << std::endl;
+        close(new_sockfd);
+        return;
+    }
+
+    if(m_shared_event_loop) {
+        conn->sockfd = new_sockfd;
+        conn->escaper.start_decoder();
+        taste::EventLoop::shared().add(new_sockfd, &linux_ip_socket_private_data::connection_ready, conn);
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.ptr = conn;
+    if(epoll_ctl(m_epollfd, EPOLL_CTL_ADD, new_sockfd, &event) == EPOLL_ERROR) {
+        std::cerr << "Cannot watch accepted socket: " << strerror(errno) << std::endl;
+        close(new_sockfd);
+        return;
     }
+
+    conn->sockfd = new_sockfd;
+    conn->escaper.start_decoder();
 }
 
 void
-linux_ip_socket_private_data::handle_connection(pollfd* table)
+linux_ip_socket_private_data::close_connection(connection* const conn)
 {
-    Escaper_start_decoder(&escaper);
-    while(true) {
-        // wait for data on listen without timeout
-        const int poll_result = ::poll(table, 1, POLL_NO_TIMEOUT);
-        if(poll_result == POLL_ERROR) {
-            std::cerr << "poll() returned an error: " << strerror(errno) << std::endl;
-            std::cerr << "aborting." << std::endl;
-            abort();
-        }
-
-        if(table[0].revents & POLLIN) {
-            if(!read_data_or_disconnect(table)) {
-                break;
-            }
-        }
+    // closing the descriptor removes it from the epoll set, but the shared loop also forgets its handler
+    if(m_shared_event_loop) {
+        taste::EventLoop::shared().remove(conn->sockfd);
     }
+    close(conn->sockfd);
+    conn->sockfd = INVALID_SOCKET_ID;
 }
 
 bool
-linux_ip_socket_private_data::read_data_or_disconnect(pollfd* table)
+linux_ip_socket_private_data::read_data_or_disconnect(connection* const conn)
 {
-    const int recv_result = recv(table[0].fd, m_recv_buffer, DRIVER_RECV_BUFFER_SIZE, 0);
+    const ssize_t recv_result = recv(conn->sockfd, m_recv_buffer, DRIVER_RECV_BUFFER_SIZE, 0);
     if(recv_result == RECV_ERROR) {
+        if(errno == EAGAIN || errno == EINTR) {
+            return true;
+        }
         std::cerr << "recv() returned an error: " << std::strerror(errno) << std::endl;
-        close(table[0].fd);
-        table[0].fd = 0;
-        table[0].events = 0;
         return false;
     } else if(recv_result == RECV_CONNECTION_SHUTDOWN) {
-        close(table[0].fd);
-        table[0].fd = 0;
-        table[0].events = 0;
         return false;
     } else {
-        const size_t length = static_cast<const size_t>(recv_result);
-        Escaper_decode_packet(&escaper, m_ip_device_bus_id, m_recv_buffer, length, Broker_receive_packet);
+        const size_t length = static_cast<size_t>(recv_result);
+        m_delivery.begin(m_recv_buffer, length);
+        m_delivery.decode(conn->escaper, m_recv_buffer, length);
+        m_delivery.flush();
         return true;
     }
 }
@@ -329,6 +572,13 @@ LinuxIpSocketPoll(void* private_data)
     self->driver_poll();
 }
 
+void
+LinuxIpSocketManageConnection(void* private_data)
+{
+    linux_ip_socket_private_data* self = reinterpret_cast<linux_ip_socket_private_data*>(private_data);
+    self->driver_manage_connection();
+}
+
 void
 LinuxIpSocketSend(void* private_data, const uint8_t* const data, const size_t length)
 {
@@ -336,6 +586,13 @@ LinuxIpSocketSend(void* private_data, const uint8_t* const data, const size_t le
     self->driver_send(data, length);
 }
 
+void
+LinuxIpSocketSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_ip_socket_private_data* self = reinterpret_cast<linux_ip_socket_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
+
 void
 LinuxIpSocketInit(void* private_data,
                   const enum SystemBus bus_id,
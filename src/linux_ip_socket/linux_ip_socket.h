@@ -29,14 +29,22 @@
  *
  */
 
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
-#include <poll.h>
 
+#include <CacheLine.h>
+#include <DeliveryBatch.h>
+#include <DriverThread.h>
+#include <EventLoop.h>
+#include <FastEscaper.h>
+#include <Fragments.h>
+#include <SendQueue.h>
 #include <Thread.h>
 #include <system_spec.h>
 
@@ -45,7 +53,6 @@
 extern "C"
 {
 #include <Broker.h>
-#include <Escaper.h>
 }
 
 /**
@@ -69,7 +76,8 @@ class linux_ip_socket_private_data final
     /**
      * @brief Initialize driver.
      *
-     * Driver needs to be initialized before start.
+     * Driver needs to be initialized before start. The address of the remote device
+     * is resolved only once, here.
      *
      * @param bus_id         Identifier of the bus, which is used by driver
      * @param device_id      Identifier of the device
@@ -83,17 +91,44 @@ class linux_ip_socket_private_data final
     /**
      * @brief Receive data from remote partitions.
      *
-     * This function receives data from remote partition and sends it to the Broker.
+     * This function receives data from remote partitions and sends it to the Broker.
+     * All connections are served by a single epoll loop, so many remote partitions
+     * can be connected at the same time and none of them blocks the others.
+     * If the Broker accepts batches, all packets decoded from one recv() are passed together.
+     *
+     * It is not used when shared-event-loop is set; the sockets are then served
+     * by taste::EventLoop::shared instead.
      */
     void driver_poll();
     /**
      * @brief send data to remote partition.
      *
+     * If the send queue is configured, data is only queued and sent later by the driver's
+     * sending thread.
+     *
      * @param data           The Buffer which data to send to connected remote partition
      * @param length         The size of the buffer
      */
     void driver_send(const uint8_t* data, const size_t length);
 
+    /**
+     * @brief send data made of fragments to remote partition.
+     *
+     * Fragments are encoded directly, without gathering them into one buffer first.
+     * If the send queue is configured, they are copied into a queue slot instead.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Get counters of the send queue.
+     *
+     * @return Snapshot of the send queue counters
+     */
+    taste::SendQueueStatistics driver_send_queue_statistics() const;
+
     /**
      * @brief send data to remote partition.
      *
@@ -104,28 +139,56 @@ class linux_ip_socket_private_data final
      */
     void driver_send_new_connection(const uint8_t* data, const size_t length);
 
+    /**
+     * @brief send data made of fragments to remote partition over a new connection.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send_new_connection(const struct iovec* const fragments, const size_t count);
+
     /**
      * @brief send data to remote partition.
      *
-     * The established connection is reused between calls. In case of disconnect or error,
-     * a new connection is established.
+     * The connection is kept up by the connection manager thread. In case of disconnect or error,
+     * the connection manager establishes a new one in the background. Data sent while there is no
+     * connection is dropped, so the caller never waits for connect.
      *
      * @param data           The Buffer which data to send to connected remote partition
      * @param length         The size of the buffer
      */
     void driver_send_reuse_connection(const uint8_t* data, const size_t length);
 
+    /**
+     * @brief send data made of fragments to remote partition over the kept connection.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send_reuse_connection(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Keep the connection to remote partition up.
+     *
+     * This function works in a separate thread and reconnects with bounded exponential
+     * backoff whenever the connection used by driver_send_reuse_connection is lost.
+     */
+    void driver_manage_connection();
+
   private:
     static constexpr int DRIVER_THREAD_PRIORITY = 1;
     static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
-    static constexpr int DRIVER_MAX_CONNECTIONS = 1;
+    static constexpr int DRIVER_MAX_CONNECTIONS = 16;
+    static constexpr int EPOLL_MAX_EVENTS = DRIVER_MAX_CONNECTIONS + 1;
     static constexpr size_t DRIVER_RECV_BUFFER_SIZE = 1 * 1024;
-    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 1 * 1024;
     static constexpr size_t DECODED_PACKET_BUFFER_SIZE = BROKER_BUFFER_SIZE;
+    // every byte is escaped at most into two, plus start and stop markers,
+    // so the whole packet is encoded at once and sent with a single syscall
+    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 2 * DECODED_PACKET_BUFFER_SIZE + 2;
 
     static constexpr int INVALID_SOCKET_ID = -1;
     static constexpr int POLL_NO_TIMEOUT = -1;
-    static constexpr int POLL_ERROR = -1;
+    static constexpr int EPOLL_ERROR = -1;
     static constexpr int SEND_ERROR = -1;
     static constexpr int RECV_ERROR = -1;
     static constexpr int RECV_CONNECTION_SHUTDOWN = 0;
@@ -133,28 +196,76 @@ class linux_ip_socket_private_data final
     static constexpr int LISTEN_ERROR = -1;
     static constexpr int BIND_ERROR = -1;
 
+    static constexpr int RECONNECT_BACKOFF_MIN_MS = 10;
+    static constexpr int RECONNECT_BACKOFF_MAX_MS = 1000;
+
+    /**
+     * @brief State of a single accepted connection.
+     *
+     * Every connection has its own decoder, so data received from different
+     * remote partitions is never mixed in one decoded packet.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) connection
+    {
+        linux_ip_socket_private_data* driver;
+        int sockfd;
+        taste::FastEscaper escaper;
+        uint8_t decoded_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
+    };
+
+    /**
+     * @brief State used to encode sent data.
+     *
+     * The mutex serializes threads calling driver_send, so they never share the encoder.
+     * It is kept on separate cache lines from the state used by the receiving thread.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) encoder_context
+    {
+        std::mutex mutex;
+        taste::FastEscaper escaper;
+        uint8_t encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
+    };
+
   private:
+    static void transmit_queued(void* private_data, const uint8_t* data, size_t length);
+    void transmit(const struct iovec* const fragments, const size_t count);
+    void init_send_queue();
+    void init_thread_settings();
     void find_addresses(addrinfo** target, const char* address, const unsigned int port);
     bool send_packet(const int sockfd, const uint8_t* buffer, const size_t buffer_length);
+    void resolve_remote_address();
     int connect_to_remote_driver();
+    void drop_send_connection();
     void prepare_listen_socket();
-    bool accept_connection(pollfd* table);
-    void handle_connection(pollfd* table);
-    bool read_data_or_disconnect(pollfd* table);
+    void prepare_epoll();
+    static void listen_ready(void* private_data, uint32_t events);
+    static void connection_ready(void* ready_connection, uint32_t events);
+    void accept_connection();
+    void close_connection(connection* const conn);
+    bool read_data_or_disconnect(connection* const conn);
 
   private:
     int m_listen_sockfd;
+    int m_epollfd;
     int m_send_sockfd;
     enum SystemBus m_ip_device_bus_id;
     enum SystemDevice m_ip_device_id;
     const Socket_IP_Conf_T* m_ip_device_configuration;
     const Socket_IP_Conf_T* m_ip_remote_device_configuration;
-    taste::Thread m_thread;
+    taste::DriverThread m_thread;
+    taste::Thread m_connection_thread;
+    taste::SendQueue m_send_queue;
 
-    uint8_t m_recv_buffer[DRIVER_RECV_BUFFER_SIZE];
-    uint8_t m_encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
-    uint8_t m_decoded_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
-    Escaper escaper;
+    sockaddr_storage m_remote_address;
+    socklen_t m_remote_address_length;
+    int m_remote_address_family;
+    bool m_shared_event_loop;
+    std::condition_variable m_send_disconnected;
+
+    encoder_context m_encoder;
+    alignas(taste::CACHE_LINE_SIZE) uint8_t m_recv_buffer[DRIVER_RECV_BUFFER_SIZE];
+    taste::DeliveryBatch m_delivery;
+    connection m_connections[DRIVER_MAX_CONNECTIONS];
 };
 
 namespace taste {
@@ -168,6 +279,16 @@ namespace taste {
  */
 void LinuxIpSocketPoll(void* private_data);
 
+/**
+ * @brief Function which keeps the connection to remote partition up.
+ *
+ * Functions works in separate thread, which is started by LinuxIpSocketInit
+ * when the send socket is reused.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ */
+void LinuxIpSocketManageConnection(void* private_data);
+
 /**
  * @brief Send data to remote partition.
  *
@@ -179,6 +300,17 @@ void LinuxIpSocketPoll(void* private_data);
  */
 void LinuxIpSocketSend(void* private_data, const uint8_t* const data, const size_t length);
 
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxIpSocketSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
+
 /**
  * @brief Initialize driver.
  *
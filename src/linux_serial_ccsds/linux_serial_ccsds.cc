@@ -21,22 +21,41 @@
  */
 
 #include "linux_serial_ccsds.h"
+#include "serial_port.h"
 
 #include <fcntl.h>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
 #include <termios.h>
 #include <unistd.h>
 #include <iostream>
 
+// FastEscaper passes decoded packets to a callback without driver context,
+// so the decoding thread keeps track of the driver it decodes for
+static thread_local linux_serial_ccsds_private_data* decoding_driver = nullptr;
+
 linux_serial_ccsds_private_data::linux_serial_ccsds_private_data()
     : m_serialFd(-1)
     , m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_send_queue(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_decoder_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_idle_gap(NO_IDLE_GAP)
+    , m_idle_timerfd(INVALID_FD)
+    , m_tx_drain(false)
+    , m_compression(false)
+    , m_shared_event_loop(false)
 {
-    Escaper_init(&escaper,
-                 m_encoded_packet_buffer,
-                 ENCODED_PACKET_BUFFER_SIZE,
-                 m_decoded_packet_buffer,
-                 DECODED_PACKET_BUFFER_SIZE);
+    m_encoder.coalesced_length = 0;
+    m_encoder.coalesced_packets = 0;
+    m_decoder.frame_pending = false;
+    m_encoder.escaper.init(m_encoder.encoded_packet_buffer, ENCODED_PACKET_BUFFER_SIZE, nullptr, 0);
+    m_decoder.escaper.init(nullptr, 0, m_decoder.decoded_packet_buffer, COMPRESSED_PACKET_BUFFER_SIZE);
 }
 
 linux_serial_ccsds_private_data::~linux_serial_ccsds_private_data()
@@ -44,77 +63,52 @@ linux_serial_ccsds_private_data::~linux_serial_ccsds_private_data()
     if(m_serialFd != -1) {
         close(m_serialFd);
     }
-}
-
-inline void
-linux_serial_ccsds_private_data::driver_init_baudrate(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
-{
-    switch(device->speed) {
-        case Serial_CCSDS_Linux_Baudrate_T_b9600:
-            *cflags |= B9600;
-            break;
-        case Serial_CCSDS_Linux_Baudrate_T_b19200:
-            *cflags |= B19200;
-            break;
-        case Serial_CCSDS_Linux_Baudrate_T_b38400:
-            *cflags |= B38400;
-            break;
-        case Serial_CCSDS_Linux_Baudrate_T_b57600:
-            *cflags |= B57600;
-            break;
-        case Serial_CCSDS_Linux_Baudrate_T_b115200:
-            *cflags |= B115200;
-            break;
-        case Serial_CCSDS_Linux_Baudrate_T_b230400:
-            *cflags |= B230400;
-            break;
-        default:
-            *cflags |= B115200;
-            std::cerr << "Not supported baudrate value, defaulting to 115200\r\n";
+    if(m_idle_timerfd != INVALID_FD) {
+        close(m_idle_timerfd);
     }
 }
 
 inline void
-linux_serial_ccsds_private_data::driver_init_character_size(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
+linux_serial_ccsds_private_data::driver_init_send_queue(const Serial_CCSDS_Linux_Conf_T* const device)
 {
-    switch(device->bits) {
-        case 5:
-            *cflags |= CS5;
-            break;
-        case 6:
-            *cflags |= CS6;
-            break;
-        case 7:
-            *cflags |= CS7;
-            break;
-        case 8:
-            *cflags |= CS8;
-            break;
-        default:
-            *cflags |= CS8;
-            std::cerr << "Not supported character size, defaulting to 8 bits\r\n";
+    if(!device->exist.send_queue_size || device->send_queue_size == 0) {
+        return;
     }
-}
 
-inline void
-linux_serial_ccsds_private_data::driver_init_parity(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
-{
-    if(device->use_paritybit) {
-        *cflags |= PARENB;
-        switch(device->parity) {
-            case Serial_CCSDS_Linux_Parity_T_odd:
-                *cflags |= PARODD;
+    taste::SendQueuePolicy policy = taste::SendQueuePolicy::Block;
+    if(device->exist.send_queue_policy) {
+        switch(device->send_queue_policy) {
+            case Serial_CCSDS_Linux_Send_Queue_Policy_T_block:
+                policy = taste::SendQueuePolicy::Block;
+                break;
+            case Serial_CCSDS_Linux_Send_Queue_Policy_T_drop_oldest:
+                policy = taste::SendQueuePolicy::DropOldest;
                 break;
-            case Serial_CCSDS_Linux_Parity_T_even:
-                *cflags &= ~PARODD;
+            case Serial_CCSDS_Linux_Send_Queue_Policy_T_reject:
+                policy = taste::SendQueuePolicy::Reject;
                 break;
             default:
-                *cflags &= ~PARENB;
-                std::cerr << "Not supported parity type deaulting to no parity";
+                std::cerr << "Not supported send queue policy, defaulting to block\r\n";
         }
-    } else {
-        *cflags &= ~PARENB;
     }
+
+    m_send_queue.init(device->send_queue_size, policy, DECODED_PACKET_BUFFER_SIZE);
+    m_send_queue.start(&linux_serial_ccsds_private_data::transmit_queued,
+                       this,
+                       &linux_serial_ccsds_private_data::flush_queued);
+}
+
+void
+linux_serial_ccsds_private_data::init_thread_settings()
+{
+    if(!m_serial_device_configuration->exist.recv_thread) {
+        return;
+    }
+
+    taste::ThreadSettings settings = m_thread.settings();
+    taste::ThreadSettingsFromConfig(m_serial_device_configuration->recv_thread, &settings);
+    m_thread.configure(settings);
+    m_decoder_thread.configure(settings);
 }
 
 void
@@ -127,48 +121,57 @@ linux_serial_ccsds_private_data::driver_init(const SystemBus bus_id,
     m_serial_device_id = device_id;
     m_serial_device_configuration = device_configuration;
     m_serial_remote_device_configuration = remote_device_configuration;
-    /// Open UART device
-    /**
-     * Access mode      O_RDWR - read write access mode
-     * Blocking mode    O_NDELAY - non blocking mode
-     * File type        O_NOCTTY - pathname will refer to tty
-     */
-    m_serialFd = open(device_configuration->devname, O_RDWR | O_NOCTTY);
+    m_decoder.delivery.init(bus_id);
+    m_serialFd = taste::SerialPortOpen(device_configuration);
     if(m_serialFd == -1) {
         std::cerr << "Error while opening a file \n\r";
         exit(EXIT_FAILURE);
     }
 
-    /// Configure UART
-    struct termios options;
-
-    int cflags = 0;
-
-    driver_init_baudrate(device_configuration, &cflags);
-    driver_init_character_size(device_configuration, &cflags);
-    driver_init_parity(device_configuration, &cflags);
+    if(device_configuration->exist.recv_idle_gap) {
+        m_idle_gap = static_cast<int>(device_configuration->recv_idle_gap);
+    }
+    m_tx_drain = device_configuration->exist.tx_drain && device_configuration->tx_drain;
+    m_compression = device_configuration->exist.compression && device_configuration->compression;
+    m_shared_event_loop = device_configuration->exist.shared_event_loop && device_configuration->shared_event_loop;
+    if(device_configuration->exist.recv_pipeline_size && !m_shared_event_loop) {
+        m_recv_ring.init(device_configuration->recv_pipeline_size);
+    }
 
-    tcgetattr(m_serialFd, &options);
-    options.c_cflag = cflags | CLOCAL | CREAD;
-    options.c_iflag = IGNPAR;
-    options.c_oflag = 0;
-    options.c_lflag = 0;
-    tcflush(m_serialFd, TCIFLUSH);
-    tcsetattr(m_serialFd, TCSANOW, &options);
+    driver_init_send_queue(device_configuration);
+    init_thread_settings();
 
-    m_thread.start(&taste::LinuxSerialCcsdsPoll, this);
+    if(m_shared_event_loop) {
+        init_shared_event_loop();
+    } else {
+        m_thread.start(&taste::LinuxSerialCcsdsPoll, this);
+    }
 }
 
 void
 linux_serial_ccsds_private_data::driver_poll()
 {
+    if(m_recv_ring.is_enabled()) {
+        m_decoder_thread.start(&linux_serial_ccsds_private_data::decode_pipelined, this);
+        read_into_ring();
+        return;
+    }
+
     ssize_t length{ 0 };
-    Escaper_start_decoder(&escaper);
+    m_decoder.escaper.start_decoder();
     while(1) {
         if(m_serialFd != -1) {
-            length = read(m_serialFd, m_recv_buffer, DRIVER_RECV_BUFFER_SIZE);
+            if(!wait_for_data()) {
+                resynchronize_decoder();
+                continue;
+            }
+            length = read(m_serialFd, m_decoder.recv_buffer, DRIVER_RECV_BUFFER_SIZE);
             if(length > 0) {
-                Escaper_decode_packet(&escaper, m_serial_device_bus_id, m_recv_buffer, length, Broker_receive_packet);
+                decode(m_decoder.recv_buffer, static_cast<size_t>(length));
+                m_decoder.frame_pending = true;
+            } else if(length == 0) {
+                // VTIME expired without data
+                resynchronize_decoder();
             } else if (length < 0) {
                 std::cerr << "Error while polling. Cannot read.\n\r";
                 exit(EXIT_FAILURE);
@@ -180,25 +183,419 @@ linux_serial_ccsds_private_data::driver_poll()
     }
 }
 
+bool
+linux_serial_ccsds_private_data::wait_for_data()
+{
+    if(m_idle_gap == NO_IDLE_GAP) {
+        return true;
+    }
+
+    struct pollfd descriptor;
+    descriptor.fd = m_serialFd;
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
+    int result = poll(&descriptor, 1, m_idle_gap);
+    while(result < 0 && errno == EINTR) {
+        result = poll(&descriptor, 1, m_idle_gap);
+    }
+    if(result < 0) {
+        std::cerr << "Error while polling. Cannot wait for data.\n\r";
+        exit(EXIT_FAILURE);
+    }
+    return result > 0;
+}
+
+void
+linux_serial_ccsds_private_data::read_into_ring()
+{
+    while(true) {
+        uint8_t* region = nullptr;
+        const size_t free_bytes = m_recv_ring.acquire_write(&region);
+        const ssize_t length = read(m_serialFd, region, free_bytes);
+        if(length > 0) {
+            m_recv_ring.commit_write(static_cast<size_t>(length));
+        } else if(length < 0 && errno != EINTR) {
+            std::cerr << "Error while polling. Cannot read.\n\r";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void
+linux_serial_ccsds_private_data::decode_pipelined(void* private_data)
+{
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    self->decode_from_ring();
+}
+
+void
+linux_serial_ccsds_private_data::decode_from_ring()
+{
+    // the idle gap is measured as time without new data in the ring
+    const int timeout = m_idle_gap == NO_IDLE_GAP ? taste::ByteRing::NO_TIMEOUT : m_idle_gap;
+
+    m_decoder.escaper.start_decoder();
+    while(true) {
+        uint8_t* data = nullptr;
+        const size_t length = m_recv_ring.acquire_read(&data, timeout);
+        if(length == 0) {
+            resynchronize_decoder();
+            continue;
+        }
+        decode(data, length);
+        m_recv_ring.release_read(length);
+        m_decoder.frame_pending = true;
+    }
+}
+
+void
+linux_serial_ccsds_private_data::resynchronize_decoder()
+{
+    if(m_decoder.frame_pending) {
+        // an incomplete frame would otherwise be completed with bytes of the next burst
+        m_decoder.escaper.start_decoder();
+        m_decoder.frame_pending = false;
+    }
+}
+
+void
+linux_serial_ccsds_private_data::init_shared_event_loop()
+{
+    // VMIN and VTIME are not used by non-blocking reads, the loop reads what is already received
+    fcntl(m_serialFd, F_SETFL, fcntl(m_serialFd, F_GETFL) | O_NONBLOCK);
+    m_decoder.escaper.start_decoder();
+
+    if(m_idle_gap != NO_IDLE_GAP) {
+        m_idle_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if(m_idle_timerfd == INVALID_FD) {
+            std::cerr << "Error while creating idle gap timer.\n\r";
+            exit(EXIT_FAILURE);
+        }
+        taste::EventLoop::shared().add(m_idle_timerfd, &linux_serial_ccsds_private_data::idle_gap_expired, this);
+    }
+    taste::EventLoop::shared().add(m_serialFd, &linux_serial_ccsds_private_data::device_ready, this);
+}
+
+void
+linux_serial_ccsds_private_data::device_ready(void* private_data, uint32_t events)
+{
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    if((events & (EPOLLHUP | EPOLLERR)) != 0) {
+        // the condition is level-triggered, so a device left in the loop would wake it without end
+        taste::EventLoop::shared().remove(self->m_serialFd);
+        std::cerr << "Serial device " << ((events & EPOLLHUP) != 0 ? "hung up" : "reported an error")
+                  << ", stopped receiving.\n\r";
+        return;
+    }
+    self->read_available();
+}
+
+void
+linux_serial_ccsds_private_data::idle_gap_expired(void* private_data, uint32_t events)
+{
+    (void)events;
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    uint64_t expirations = 0;
+    if(read(self->m_idle_timerfd, &expirations, sizeof(expirations)) > 0) {
+        self->resynchronize_decoder();
+    }
+}
+
+void
+linux_serial_ccsds_private_data::read_available()
+{
+    const ssize_t length = read(m_serialFd, m_decoder.recv_buffer, DRIVER_RECV_BUFFER_SIZE);
+    if(length > 0) {
+        decode(m_decoder.recv_buffer, static_cast<size_t>(length));
+        m_decoder.frame_pending = true;
+        arm_idle_timer();
+    } else if(length < 0 && errno != EAGAIN && errno != EINTR) {
+        std::cerr << "Error while polling. Cannot read.\n\r";
+        exit(EXIT_FAILURE);
+    }
+}
+
+void
+linux_serial_ccsds_private_data::arm_idle_timer()
+{
+    if(m_idle_timerfd == INVALID_FD) {
+        return;
+    }
+
+    // every read restarts the timer, so it expires only after the gap without data
+    struct itimerspec gap;
+    memset(&gap, 0, sizeof(gap));
+    gap.it_value.tv_sec = m_idle_gap / 1000;
+    gap.it_value.tv_nsec = static_cast<long>(m_idle_gap % 1000) * 1000000;
+    timerfd_settime(m_idle_timerfd, 0, &gap, nullptr);
+}
+
+void
+linux_serial_ccsds_private_data::decode(uint8_t* const data, const size_t length)
+{
+    m_decoder.delivery.begin(data, length);
+    if(!m_compression) {
+        m_decoder.delivery.decode(m_decoder.escaper, data, length);
+    } else {
+        decoding_driver = this;
+        m_decoder.escaper.decode_packet(m_serial_device_bus_id,
+                                        data,
+                                        length,
+                                        &linux_serial_ccsds_private_data::receive_compressed);
+    }
+    m_decoder.delivery.flush();
+}
+
+void
+linux_serial_ccsds_private_data::receive_compressed(const enum SystemBus bus_id,
+                                                    uint8_t* const data,
+                                                    const size_t length)
+{
+    (void)bus_id;
+    decoding_driver->decompress(data, length);
+}
+
+void
+linux_serial_ccsds_private_data::decompress(uint8_t* const data, const size_t length)
+{
+    if(taste::PacketCompressor::is_stored(data, length)) {
+        m_decoder.delivery.add(data + taste::PacketCompressor::HEADER_SIZE,
+                               length - taste::PacketCompressor::HEADER_SIZE);
+        return;
+    }
+
+    size_t packet_length = 0;
+    if(!taste::PacketCompressor::decompress(data,
+                                            length,
+                                            m_decoder.decompressed_packet_buffer,
+                                            DECODED_PACKET_BUFFER_SIZE,
+                                            &packet_length)) {
+        std::cerr << "Malformed compressed packet, dropping packet\n\r";
+        return;
+    }
+    m_decoder.delivery.add(m_decoder.decompressed_packet_buffer, packet_length);
+}
+
 void
 linux_serial_ccsds_private_data::driver_send(const uint8_t* const data, const size_t length)
 {
-    if(m_serialFd != -1) {
-        Escaper_start_encoder(&escaper);
-        size_t index = 0;
-        size_t packetLength = 0;
-
-        while(index < length) {
-            packetLength = Escaper_encode_packet(&escaper, data, length, &index);
-            int count = write(m_serialFd, m_encoded_packet_buffer, packetLength);
-            if(count < 0) {
-                std::cerr << "Serial write error\n\r";
-            }
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
+
+void
+linux_serial_ccsds_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    if(m_send_queue.is_enabled()) {
+        const taste::SendQueuePushResult result = m_send_queue.push(fragments, count);
+        if(result == taste::SendQueuePushResult::Full) {
+            std::cerr << "Send queue is full, dropping packet\n\r";
+        } else if(result == taste::SendQueuePushResult::TooLarge) {
+            std::cerr << "Packet larger than send queue slot, dropping it\n\r";
         }
     } else {
+        transmit(fragments, count);
+    }
+}
+
+taste::SendQueueStatistics
+linux_serial_ccsds_private_data::driver_send_queue_statistics() const
+{
+    return m_send_queue.statistics();
+}
+
+taste::CompressionStatistics
+linux_serial_ccsds_private_data::driver_compression_statistics() const
+{
+    return m_encoder.compressor.statistics();
+}
+
+bool
+linux_serial_ccsds_private_data::driver_line_counters(taste::SerialLineCounters* const counters) const
+{
+    struct serial_icounter_struct icount;
+    if(m_serialFd == -1 || ioctl(m_serialFd, TIOCGICOUNT, &icount) != 0) {
+        return false;
+    }
+
+    counters->rx = static_cast<uint64_t>(icount.rx);
+    counters->tx = static_cast<uint64_t>(icount.tx);
+    counters->frame = static_cast<uint64_t>(icount.frame);
+    counters->overrun = static_cast<uint64_t>(icount.overrun);
+    counters->parity = static_cast<uint64_t>(icount.parity);
+    counters->brk = static_cast<uint64_t>(icount.brk);
+    counters->buffer_overrun = static_cast<uint64_t>(icount.buf_overrun);
+    return true;
+}
+
+void
+linux_serial_ccsds_private_data::transmit_queued(void* private_data, const uint8_t* data, size_t length)
+{
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    self->coalesce(data, length);
+}
+
+void
+linux_serial_ccsds_private_data::flush_queued(void* private_data)
+{
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    std::lock_guard<std::mutex> lock(self->m_encoder.mutex);
+    self->write_coalesced();
+}
+
+void
+linux_serial_ccsds_private_data::transmit(const struct iovec* const fragments, const size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_encoder.mutex);
+
+    if(m_serialFd == -1) {
         std::cerr << "Error while sending. Wrong file descriptor\n\r";
         exit(EXIT_FAILURE);
     }
+
+    if(!m_compression) {
+        write_encoded(fragments, count);
+        return;
+    }
+
+    const size_t length = taste::FragmentsLength(fragments, count);
+    if(length > DECODED_PACKET_BUFFER_SIZE) {
+        std::cerr << "Packet too large for compression, dropping packet\n\r";
+        return;
+    }
+    // the compressor needs the whole packet in one buffer
+    const uint8_t* data = m_encoder.gathered_packet_buffer;
+    if(count == 1) {
+        data = static_cast<const uint8_t*>(fragments[0].iov_base);
+    } else {
+        taste::FragmentsGather(fragments, count, m_encoder.gathered_packet_buffer);
+    }
+    const uint8_t* packet = nullptr;
+    struct iovec compressed;
+    compressed.iov_len = prepare_packet(data, length, &packet);
+    compressed.iov_base = const_cast<uint8_t*>(packet);
+    write_encoded(&compressed, 1);
+}
+
+void
+linux_serial_ccsds_private_data::write_encoded(const struct iovec* const fragments, const size_t count)
+{
+    const size_t length = taste::FragmentsLength(fragments, count);
+
+    m_encoder.escaper.start_encoder();
+    size_t index = 0;
+    size_t packetLength = 0;
+
+    while(index < length) {
+        packetLength = m_encoder.escaper.encode_fragments(fragments, count, &index);
+        if(!write_all(m_encoder.encoded_packet_buffer, packetLength)) {
+            break;
+        }
+    }
+    drain_written();
+}
+
+size_t
+linux_serial_ccsds_private_data::prepare_packet(const uint8_t* const data,
+                                                const size_t length,
+                                                const uint8_t** const packet)
+{
+    if(!m_compression) {
+        *packet = data;
+        return length;
+    }
+    *packet = m_encoder.compressed_packet_buffer;
+    return m_encoder.compressor.compress(data, length, m_encoder.compressed_packet_buffer);
+}
+
+void
+linux_serial_ccsds_private_data::coalesce(const uint8_t* const data, const size_t length)
+{
+    std::lock_guard<std::mutex> lock(m_encoder.mutex);
+
+    const uint8_t* packet = nullptr;
+    const size_t packet_length = prepare_packet(data, length, &packet);
+
+    m_encoder.escaper.start_encoder();
+    ++m_encoder.coalesced_packets;
+    size_t index = 0;
+    while(index < packet_length) {
+        const size_t packetLength = m_encoder.escaper.encode_packet(packet, packet_length, &index);
+        if(m_encoder.coalesced_length + packetLength > COALESCED_BUFFER_SIZE) {
+            if(!write_coalesced()) {
+                // the beginning of the packet is lost, so the rest is not worth sending
+                return;
+            }
+            // the rest of the packet goes into the next write
+            m_encoder.coalesced_packets = 1;
+        }
+        memcpy(&m_encoder.coalesced_buffer[m_encoder.coalesced_length], m_encoder.encoded_packet_buffer, packetLength);
+        m_encoder.coalesced_length += packetLength;
+    }
+}
+
+bool
+linux_serial_ccsds_private_data::write_coalesced()
+{
+    if(m_encoder.coalesced_length == 0) {
+        return true;
+    }
+    const bool written = write_all(m_encoder.coalesced_buffer, m_encoder.coalesced_length);
+    if(!written) {
+        std::cerr << "Dropping " << m_encoder.coalesced_packets << " coalesced packets\n\r";
+        m_send_queue.add_dropped(m_encoder.coalesced_packets);
+    }
+    m_encoder.coalesced_length = 0;
+    m_encoder.coalesced_packets = 0;
+    drain_written();
+    return written;
+}
+
+bool
+linux_serial_ccsds_private_data::write_all(const uint8_t* buffer, size_t length)
+{
+    // the UART may accept only part of the data, e.g. when its transmit buffer is almost full
+    while(length > 0) {
+        const ssize_t count = write(m_serialFd, buffer, length);
+        if(count < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno == EAGAIN && wait_for_write()) {
+                // the descriptor is non-blocking when it is shared with the event loop
+                continue;
+            }
+            std::cerr << "Serial write error: " << strerror(errno) << "\n\r";
+            return false;
+        }
+        buffer += count;
+        length -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool
+linux_serial_ccsds_private_data::wait_for_write()
+{
+    struct pollfd descriptor;
+    descriptor.fd = m_serialFd;
+    descriptor.events = POLLOUT;
+    descriptor.revents = 0;
+    int result = poll(&descriptor, 1, POLL_NO_TIMEOUT);
+    while(result < 0 && errno == EINTR) {
+        result = poll(&descriptor, 1, POLL_NO_TIMEOUT);
+    }
+    return result > 0;
+}
+
+void
+linux_serial_ccsds_private_data::drain_written()
+{
+    if(m_tx_drain && tcdrain(m_serialFd) != 0) {
+        std::cerr << "Serial drain error: " << strerror(errno) << "\n\r";
+    }
 }
 
 namespace taste {
@@ -227,4 +624,11 @@ LinuxSerialCcsdsSend(void* private_data, const uint8_t* const data, const size_t
     linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
     self->driver_send(data, length);
 }
+
+void
+LinuxSerialCcsdsSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_serial_ccsds_private_data* self = reinterpret_cast<linux_serial_ccsds_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
 } // namespace taste
@@ -30,7 +30,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
+#include <ByteRing.h>
+#include <CacheLine.h>
+#include <DeliveryBatch.h>
+#include <DriverThread.h>
+#include <EventLoop.h>
+#include <FastEscaper.h>
+#include <Fragments.h>
+#include <PacketCompressor.h>
+#include <SendQueue.h>
 #include <Thread.h>
 #include <system_spec.h>
 
@@ -39,9 +49,26 @@
 extern "C"
 {
 #include <Broker.h>
-#include <Escaper.h>
 }
 
+namespace taste {
+
+/**
+ * @brief Error and transfer counters of a serial line, as reported by the UART driver.
+ */
+struct SerialLineCounters
+{
+    uint64_t rx;             ///< Number of received characters
+    uint64_t tx;             ///< Number of transmitted characters
+    uint64_t frame;          ///< Number of framing errors
+    uint64_t overrun;        ///< Number of characters lost by UART hardware overruns
+    uint64_t parity;         ///< Number of parity errors
+    uint64_t brk;            ///< Number of received breaks
+    uint64_t buffer_overrun; ///< Number of characters lost because the tty buffer was full
+};
+
+} // namespace taste
+
 /**
  * @brief Structure for driver internal data.
  *
@@ -85,38 +112,171 @@ class linux_serial_ccsds_private_data final
      * @brief Receive data from remote partitions.
      *
      * This function receives data from remote partition and sends it to the Broker.
+     * If recv-idle-gap is configured and no data arrives for that long, a partially
+     * received frame is discarded and the decoder is restarted.
+     *
+     * If recv-pipeline-size is configured, this thread only reads the device into a ring
+     * and a second thread decodes packets from it, so the device is drained even while
+     * the Broker is busy.
+     * With compression decoded packets are decompressed before they are passed to the Broker;
+     * malformed packets are dropped.
+     * If the Broker accepts batches, all packets decoded from one read are passed together.
+     *
+     * It is not used when shared-event-loop is set; the device is then read without blocking
+     * by taste::EventLoop::shared and the idle gap is measured with a timerfd. Sending still
+     * waits until the device accepts all data. A device which hangs up is removed from the loop.
      */
     void driver_poll();
     /**
      * @brief Send data to remote partition.
      *
+     * If the send queue is configured, data is only queued and sent later by the driver's
+     * sending thread, which writes all packets queued at the time with as few write() calls
+     * as possible.
+     * With compression the packet is compressed before it is escaped, unless it would not
+     * get smaller.
+     *
      * @param data           The Buffer which data to send to connected remote partition
      * @param length         The size of the buffer
      */
     void driver_send(const uint8_t* data, const size_t length);
 
+    /**
+     * @brief Send data made of fragments to remote partition.
+     *
+     * Fragments are encoded directly, without gathering them into one buffer first,
+     * unless compression is configured. If the send queue is configured, they are
+     * copied into a queue slot instead.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Get counters of the send queue.
+     *
+     * @return Snapshot of the send queue counters
+     */
+    taste::SendQueueStatistics driver_send_queue_statistics() const;
+
+    /**
+     * @brief Get error and transfer counters of the serial line.
+     *
+     * Counters are read with TIOCGICOUNT, which is not implemented by every
+     * UART driver, e.g. pseudo terminals.
+     *
+     * @param counters       Filled with the counters
+     *
+     * @return true if the counters were read, false otherwise
+     */
+    bool driver_line_counters(taste::SerialLineCounters* const counters) const;
+
+    /**
+     * @brief Get counters of sent packet compression.
+     *
+     * The achieved compression ratio is input_bytes / output_bytes.
+     *
+     * @return Snapshot of the compression counters
+     */
+    taste::CompressionStatistics driver_compression_statistics() const;
+
   private:
     static constexpr int DRIVER_THREAD_PRIORITY = 1;
     static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
     static constexpr size_t DRIVER_RECV_BUFFER_SIZE = 1 * 1024;
-    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 1 * 1024;
     static constexpr size_t DECODED_PACKET_BUFFER_SIZE = BROKER_BUFFER_SIZE;
+    // compressed packet is never larger than the packet and the compression header
+    static constexpr size_t COMPRESSED_PACKET_BUFFER_SIZE =
+            DECODED_PACKET_BUFFER_SIZE + taste::PacketCompressor::HEADER_SIZE;
+    // every byte is escaped at most into two, plus start and stop markers,
+    // so the whole packet is encoded at once and sent with a single syscall
+    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 2 * COMPRESSED_PACKET_BUFFER_SIZE + 2;
+    // encoded packets taken from the send queue are gathered here and written together
+    static constexpr size_t COALESCED_BUFFER_SIZE = ENCODED_PACKET_BUFFER_SIZE;
+    static constexpr int NO_IDLE_GAP = -1;
+    static constexpr int INVALID_FD = -1;
+    static constexpr int POLL_NO_TIMEOUT = -1;
 
-    void driver_init_baudrate(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags);
-    void driver_init_character_size(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags);
-    void driver_init_parity(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags);
+    /**
+     * @brief State used to encode sent data.
+     *
+     * The mutex serializes threads calling driver_send, so they never share the encoder.
+     * It is kept on separate cache lines from the state used by the receiving thread.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) encoder_context
+    {
+        std::mutex mutex;
+        taste::FastEscaper escaper;
+        uint8_t encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
+        uint8_t coalesced_buffer[COALESCED_BUFFER_SIZE];
+        size_t coalesced_length;
+        // packets with data in coalesced_buffer
+        uint64_t coalesced_packets;
+        taste::PacketCompressor compressor;
+        uint8_t compressed_packet_buffer[COMPRESSED_PACKET_BUFFER_SIZE];
+        // fragments are gathered here only for the compressor
+        uint8_t gathered_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
+    };
+
+    /**
+     * @brief State used by the receiving thread to decode received data.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) decoder_context
+    {
+        taste::FastEscaper escaper;
+        uint8_t recv_buffer[DRIVER_RECV_BUFFER_SIZE];
+        uint8_t decoded_packet_buffer[COMPRESSED_PACKET_BUFFER_SIZE];
+        uint8_t decompressed_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
+        taste::DeliveryBatch delivery;
+        // data was decoded since the decoder was last started
+        bool frame_pending;
+    };
+
+    bool wait_for_data();
+    void read_into_ring();
+    static void decode_pipelined(void* private_data);
+    void decode_from_ring();
+    void resynchronize_decoder();
+    void init_shared_event_loop();
+    static void device_ready(void* private_data, uint32_t events);
+    static void idle_gap_expired(void* private_data, uint32_t events);
+    void read_available();
+    void arm_idle_timer();
+    void decode(uint8_t* const data, const size_t length);
+    static void receive_compressed(const enum SystemBus bus_id, uint8_t* const data, const size_t length);
+    void decompress(uint8_t* const data, const size_t length);
+    void driver_init_send_queue(const Serial_CCSDS_Linux_Conf_T* const device);
+    void init_thread_settings();
+
+    static void transmit_queued(void* private_data, const uint8_t* data, size_t length);
+    static void flush_queued(void* private_data);
+    void transmit(const struct iovec* const fragments, const size_t count);
+    void write_encoded(const struct iovec* const fragments, const size_t count);
+    size_t prepare_packet(const uint8_t* const data, const size_t length, const uint8_t** const packet);
+    void coalesce(const uint8_t* data, const size_t length);
+    bool write_coalesced();
+    bool write_all(const uint8_t* buffer, size_t length);
+    bool wait_for_write();
+    void drain_written();
 
     int m_serialFd;
     enum SystemBus m_serial_device_bus_id;
     enum SystemDevice m_serial_device_id;
     const Serial_CCSDS_Linux_Conf_T* m_serial_device_configuration{};
     const Serial_CCSDS_Linux_Conf_T* m_serial_remote_device_configuration{};
-    taste::Thread m_thread;
+    taste::DriverThread m_thread;
+    taste::SendQueue m_send_queue;
+    taste::DriverThread m_decoder_thread;
+    taste::ByteRing m_recv_ring;
+    int m_idle_gap;
+    int m_idle_timerfd;
+    bool m_tx_drain;
+    bool m_compression;
+    bool m_shared_event_loop;
 
-    uint8_t m_recv_buffer[DRIVER_RECV_BUFFER_SIZE];
-    uint8_t m_encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
-    uint8_t m_decoded_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
-    Escaper escaper{};
+    encoder_context m_encoder;
+    decoder_context m_decoder;
 };
 
 namespace taste {
@@ -157,6 +317,17 @@ void LinuxSerialCcsdsPoll(void* private_data);
  * @param length         The size of the buffer
  */
 void LinuxSerialCcsdsSend(void* private_data, const uint8_t* const data, const size_t length);
+
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxSerialCcsdsSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
 } // namespace taste
 
 #endif
@@ -0,0 +1,56 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "serial_baudrate.h"
+
+// termios2 is defined only by kernel headers, which cannot be combined with <termios.h>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+namespace taste {
+
+bool
+SerialSetCustomBaudrate(const int fd, const uint32_t baudrate, uint32_t* const actual)
+{
+    struct termios2 options;
+    if(ioctl(fd, TCGETS2, &options) != 0) {
+        return false;
+    }
+
+    // the same rate is used for output and input
+    options.c_cflag &= static_cast<tcflag_t>(~(CBAUD | (CBAUD << IBSHIFT)));
+    options.c_cflag |= static_cast<tcflag_t>(BOTHER | (BOTHER << IBSHIFT));
+    options.c_ospeed = baudrate;
+    options.c_ispeed = baudrate;
+    if(ioctl(fd, TCSETS2, &options) != 0) {
+        return false;
+    }
+
+    // the driver may round the rate to what its clock divider allows
+    if(ioctl(fd, TCGETS2, &options) != 0) {
+        return false;
+    }
+    *actual = options.c_ospeed;
+    return true;
+}
+
+} // namespace taste
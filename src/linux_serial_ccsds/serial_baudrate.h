@@ -0,0 +1,51 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERIAL_BAUDRATE_H
+#define SERIAL_BAUDRATE_H
+
+/**
+ * @file     serial_baudrate.h
+ * @brief    Setting of baudrates not covered by termios speed constants
+ */
+
+#include <cstdint>
+
+namespace taste {
+
+/**
+ * @brief Set an arbitrary baudrate on a serial device.
+ *
+ * Uses termios2 with BOTHER, so the rate is not limited to Bnnn constants.
+ * Other terminal settings of the device are not changed.
+ *
+ * @param fd             File descriptor of the serial device
+ * @param baudrate       Requested baudrate in bits per second
+ * @param actual         Baudrate reported by the device after the change
+ *
+ * @return true if the baudrate was set, false otherwise
+ */
+bool SerialSetCustomBaudrate(const int fd, const uint32_t baudrate, uint32_t* const actual);
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,249 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "serial_port.h"
+#include "serial_baudrate.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+
+namespace taste {
+
+static constexpr cc_t DEFAULT_RECV_MIN_BYTES = 1;
+static constexpr cc_t DEFAULT_RECV_INTER_BYTE_TIMEOUT = 0;
+
+static void
+init_baudrate(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
+{
+    switch(device->speed) {
+        case Serial_CCSDS_Linux_Baudrate_T_b9600:
+            *cflags |= B9600;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b19200:
+            *cflags |= B19200;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b38400:
+            *cflags |= B38400;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b57600:
+            *cflags |= B57600;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b115200:
+            *cflags |= B115200;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b230400:
+            *cflags |= B230400;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b460800:
+            *cflags |= B460800;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b500000:
+            *cflags |= B500000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b576000:
+            *cflags |= B576000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b921600:
+            *cflags |= B921600;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b1000000:
+            *cflags |= B1000000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b1152000:
+            *cflags |= B1152000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b1500000:
+            *cflags |= B1500000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b2000000:
+            *cflags |= B2000000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b2500000:
+            *cflags |= B2500000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b3000000:
+            *cflags |= B3000000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b3500000:
+            *cflags |= B3500000;
+            break;
+        case Serial_CCSDS_Linux_Baudrate_T_b4000000:
+            *cflags |= B4000000;
+            break;
+        default:
+            *cflags |= B115200;
+            std::cerr << "Not supported baudrate value, defaulting to 115200\r\n";
+    }
+}
+
+static void
+init_custom_baudrate(const int fd, const Serial_CCSDS_Linux_Conf_T* const device)
+{
+    const uint32_t baudrate = static_cast<uint32_t>(device->custom_speed);
+    uint32_t actual = 0;
+    if(!taste::SerialSetCustomBaudrate(fd, baudrate, &actual)) {
+        std::cerr << "Cannot set custom baudrate " << baudrate << ", keeping speed setting\r\n";
+    } else if(actual != baudrate) {
+        std::cerr << "Custom baudrate " << baudrate << " rounded by the device to " << actual << "\r\n";
+    }
+}
+
+static void
+init_character_size(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
+{
+    switch(device->bits) {
+        case 5:
+            *cflags |= CS5;
+            break;
+        case 6:
+            *cflags |= CS6;
+            break;
+        case 7:
+            *cflags |= CS7;
+            break;
+        case 8:
+            *cflags |= CS8;
+            break;
+        default:
+            *cflags |= CS8;
+            std::cerr << "Not supported character size, defaulting to 8 bits\r\n";
+    }
+}
+
+static void
+init_parity(const Serial_CCSDS_Linux_Conf_T* const device, int* cflags)
+{
+    if(device->use_paritybit) {
+        *cflags |= PARENB;
+        switch(device->parity) {
+            case Serial_CCSDS_Linux_Parity_T_odd:
+                *cflags |= PARODD;
+                break;
+            case Serial_CCSDS_Linux_Parity_T_even:
+                *cflags &= ~PARODD;
+                break;
+            default:
+                *cflags &= ~PARENB;
+                std::cerr << "Not supported parity type deaulting to no parity";
+        }
+    } else {
+        *cflags &= ~PARENB;
+    }
+}
+
+static void
+init_flow_control(const Serial_CCSDS_Linux_Conf_T* const device, struct termios* options)
+{
+    if(!device->exist.flow_control) {
+        return;
+    }
+
+    switch(device->flow_control) {
+        case Serial_CCSDS_Linux_Flow_Control_T_none:
+            break;
+        case Serial_CCSDS_Linux_Flow_Control_T_rts_cts:
+            options->c_cflag |= CRTSCTS;
+            break;
+        default:
+            std::cerr << "Not supported flow control, defaulting to none\r\n";
+    }
+}
+
+static void
+init_receive_timing(const Serial_CCSDS_Linux_Conf_T* const device, struct termios* options)
+{
+    // set explicitly, so the receive latency does not depend on the previous user of the tty
+    options->c_cc[VMIN] =
+            device->exist.recv_min_bytes ? static_cast<cc_t>(device->recv_min_bytes) : DEFAULT_RECV_MIN_BYTES;
+    options->c_cc[VTIME] = device->exist.recv_inter_byte_timeout ? static_cast<cc_t>(device->recv_inter_byte_timeout)
+                                                                 : DEFAULT_RECV_INTER_BYTE_TIMEOUT;
+    if(options->c_cc[VMIN] == 0 && options->c_cc[VTIME] == 0) {
+        // read() would return 0 at once while there is no data, so the receiving thread would spin;
+        // returning as soon as one byte is available delivers the same data without polling
+        std::cerr << "recv-min-bytes 0 requires recv-inter-byte-timeout, using recv-min-bytes 1\r\n";
+        options->c_cc[VMIN] = DEFAULT_RECV_MIN_BYTES;
+    }
+}
+
+static void
+init_low_latency(const int fd)
+{
+    struct serial_struct serial;
+    if(ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+        std::cerr << "Low latency mode not supported by the device: " << strerror(errno) << "\r\n";
+        return;
+    }
+    serial.flags |= static_cast<int>(ASYNC_LOW_LATENCY);
+    if(ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+        std::cerr << "Cannot set low latency mode: " << strerror(errno) << "\r\n";
+    }
+}
+
+int
+SerialPortOpen(const Serial_CCSDS_Linux_Conf_T* const device)
+{
+    /// Open UART device
+    /**
+     * Access mode      O_RDWR - read write access mode
+     * Blocking mode    O_NDELAY - non blocking mode
+     * File type        O_NOCTTY - pathname will refer to tty
+     */
+    const int fd = open(device->devname, O_RDWR | O_NOCTTY);
+    if(fd == -1) {
+        return -1;
+    }
+
+    /// Configure UART
+    struct termios options;
+
+    int cflags = 0;
+
+    init_baudrate(device, &cflags);
+    init_character_size(device, &cflags);
+    init_parity(device, &cflags);
+
+    tcgetattr(fd, &options);
+    options.c_cflag = cflags | CLOCAL | CREAD;
+    options.c_iflag = IGNPAR;
+    options.c_oflag = 0;
+    options.c_lflag = 0;
+    init_receive_timing(device, &options);
+    init_flow_control(device, &options);
+    tcflush(fd, TCIFLUSH);
+    tcsetattr(fd, TCSANOW, &options);
+
+    if(device->exist.custom_speed) {
+        init_custom_baudrate(fd, device);
+    }
+    if(device->exist.low_latency && device->low_latency) {
+        init_low_latency(fd);
+    }
+
+    return fd;
+}
+
+} // namespace taste
@@ -0,0 +1,49 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+/**
+ * @file     serial_port.h
+ * @brief    Opening and configuration of a serial device
+ */
+
+#include <drivers_config.h>
+
+namespace taste {
+
+/**
+ * @brief Open and configure a serial device.
+ *
+ * Applies line settings of the configuration: speed, character size, parity,
+ * flow control, receive timing and low latency mode.
+ *
+ * @param device         Configuration of the device
+ *
+ * @return File descriptor of the device, -1 if it cannot be opened
+ */
+int SerialPortOpen(const Serial_CCSDS_Linux_Conf_T* const device);
+
+} // namespace taste
+
+#endif
@@ -0,0 +1,470 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "linux_serial_ccsds_bonded.h"
+
+#include <linux_serial_ccsds/serial_port.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// FastEscaper passes decoded packets to a callback without driver context,
+// so every receiving thread keeps track of the bond it decodes for
+static thread_local linux_serial_ccsds_bonded_private_data* receiving_bond = nullptr;
+
+linux_serial_ccsds_bonded_private_data::linux_serial_ccsds_bonded_private_data()
+    : m_device_configuration(nullptr)
+    , m_remote_device_configuration(nullptr)
+    , m_next_sequence(0)
+    , m_next_port(0)
+    , m_port_count(0)
+{
+    for(size_t i = 0; i < MAX_PORTS; ++i) {
+        m_ports[i].driver = this;
+        m_ports[i].index = i;
+        m_ports[i].fd = -1;
+        m_ports[i].alive.store(false);
+    }
+    m_reorder.synchronized = false;
+    m_reorder.expected_sequence = 0;
+    m_reorder.window = 0;
+    m_reorder.timeout = std::chrono::milliseconds(DEFAULT_REORDER_TIMEOUT);
+    m_reorder.pending = 0;
+    m_reorder.out_of_range = 0;
+}
+
+linux_serial_ccsds_bonded_private_data::~linux_serial_ccsds_bonded_private_data()
+{
+    for(size_t i = 0; i < MAX_PORTS; ++i) {
+        if(m_ports[i].fd != -1) {
+            close(m_ports[i].fd);
+        }
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::driver_init(
+        const SystemBus bus_id,
+        const SystemDevice device_id,
+        const Serial_CCSDS_Linux_Bond_Conf_T* const device_configuration,
+        const Serial_CCSDS_Linux_Bond_Conf_T* const remote_device_configuration)
+{
+    m_bus_id = bus_id;
+    m_device_id = device_id;
+    m_device_configuration = device_configuration;
+    m_remote_device_configuration = remote_device_configuration;
+
+    init_reorder(device_configuration);
+
+    m_port_count = std::min(static_cast<size_t>(device_configuration->ports.nCount), MAX_PORTS);
+    size_t opened = 0;
+    for(size_t i = 0; i < m_port_count; ++i) {
+        init_port(m_ports[i], &device_configuration->ports.arr[i]);
+        if(m_ports[i].alive.load()) {
+            ++opened;
+        }
+    }
+    if(opened == 0) {
+        std::cerr << "Error while opening ports of the bond\n\r";
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < m_port_count; ++i) {
+        if(m_ports[i].alive.load()) {
+            m_ports[i].thread.reset(new taste::Thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE));
+            m_ports[i].thread->start(&linux_serial_ccsds_bonded_private_data::receive_worker, &m_ports[i]);
+        }
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::init_reorder(const Serial_CCSDS_Linux_Bond_Conf_T* const device)
+{
+    m_reorder.window =
+            device->exist.reorder_window ? static_cast<size_t>(device->reorder_window) : DEFAULT_REORDER_WINDOW;
+    if(device->exist.reorder_timeout) {
+        m_reorder.timeout = std::chrono::milliseconds(device->reorder_timeout);
+    }
+    m_reorder.buffers.reset(new uint8_t[m_reorder.window * DECODED_PACKET_BUFFER_SIZE]);
+    m_reorder.lengths.reset(new size_t[m_reorder.window]);
+    m_reorder.filled.reset(new bool[m_reorder.window]);
+    for(size_t i = 0; i < m_reorder.window; ++i) {
+        m_reorder.lengths[i] = 0;
+        m_reorder.filled[i] = false;
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::init_port(port_context& port, const Serial_CCSDS_Linux_Conf_T* const device)
+{
+    port.encoder.init(port.encoded_packet_buffer, ENCODED_PACKET_BUFFER_SIZE, nullptr, 0);
+    port.decoder.init(nullptr, 0, port.decoded_packet_buffer, FRAMED_PACKET_BUFFER_SIZE);
+
+    port.fd = taste::SerialPortOpen(device);
+    if(port.fd == -1) {
+        std::cerr << "Error while opening " << device->devname << ", leaving it out of the bond\n\r";
+        return;
+    }
+    port.alive.store(true);
+}
+
+void
+linux_serial_ccsds_bonded_private_data::driver_send(const uint8_t* const data, const size_t length)
+{
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
+
+void
+linux_serial_ccsds_bonded_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    if(taste::FragmentsLength(fragments, count) > DECODED_PACKET_BUFFER_SIZE) {
+        std::cerr << "Packet too large, dropping it\n\r";
+        return;
+    }
+
+    port_context* port = nullptr;
+    uint32_t sequence = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_send_mutex);
+        port = select_port();
+        if(port == nullptr) {
+            std::cerr << "No working port in the bond, dropping packet\n\r";
+            return;
+        }
+        sequence = m_next_sequence++;
+    }
+
+    transmit(*port, sequence, fragments, count);
+}
+
+linux_serial_ccsds_bonded_private_data::port_context*
+linux_serial_ccsds_bonded_private_data::select_port()
+{
+    // the port with the least data still waiting for transmission, ties are resolved in turn
+    port_context* selected = nullptr;
+    int selected_queued = std::numeric_limits<int>::max();
+    for(size_t i = 0; i < m_port_count; ++i) {
+        port_context& port = m_ports[(m_next_port + i) % m_port_count];
+        if(!port.alive.load()) {
+            continue;
+        }
+        int queued = 0;
+        if(ioctl(port.fd, TIOCOUTQ, &queued) != 0) {
+            queued = 0;
+        }
+        if(queued < selected_queued) {
+            selected = &port;
+            selected_queued = queued;
+        }
+    }
+
+    if(selected != nullptr) {
+        m_next_port = (selected->index + 1) % m_port_count;
+    }
+    return selected;
+}
+
+void
+linux_serial_ccsds_bonded_private_data::transmit(port_context& port,
+                                                 const uint32_t sequence,
+                                                 const struct iovec* const fragments,
+                                                 const size_t count)
+{
+    std::lock_guard<std::mutex> lock(port.mutex);
+
+    port.framed_packet_buffer[0] = static_cast<uint8_t>(sequence >> 24);
+    port.framed_packet_buffer[1] = static_cast<uint8_t>(sequence >> 16);
+    port.framed_packet_buffer[2] = static_cast<uint8_t>(sequence >> 8);
+    port.framed_packet_buffer[3] = static_cast<uint8_t>(sequence);
+
+    // the sequence number is encoded as the first fragment, followed by the packet
+    struct iovec framed[MAX_SEND_FRAGMENTS + 1];
+    size_t framed_count = 1;
+    framed[0].iov_base = port.framed_packet_buffer;
+    if(count <= MAX_SEND_FRAGMENTS) {
+        framed[0].iov_len = SEQUENCE_NUMBER_SIZE;
+        for(size_t i = 0; i < count; ++i) {
+            framed[framed_count++] = fragments[i];
+        }
+    } else {
+        taste::FragmentsGather(fragments, count, &port.framed_packet_buffer[SEQUENCE_NUMBER_SIZE]);
+        framed[0].iov_len = SEQUENCE_NUMBER_SIZE + taste::FragmentsLength(fragments, count);
+    }
+    const size_t framed_length = taste::FragmentsLength(framed, framed_count);
+
+    port.encoder.start_encoder();
+    size_t index = 0;
+    while(index < framed_length) {
+        const size_t packet_length = port.encoder.encode_fragments(framed, framed_count, &index);
+        if(!write_all(port, port.encoded_packet_buffer, packet_length)) {
+            // the receiver skips the lost sequence number after its reorder timeout
+            fail_port(port);
+            return;
+        }
+    }
+}
+
+bool
+linux_serial_ccsds_bonded_private_data::write_all(port_context& port, const uint8_t* buffer, size_t length)
+{
+    while(length > 0) {
+        const ssize_t count = write(port.fd, buffer, length);
+        if(count < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        buffer += count;
+        length -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+void
+linux_serial_ccsds_bonded_private_data::fail_port(port_context& port)
+{
+    if(port.alive.exchange(false)) {
+        std::cerr << "Port " << port.index << " of the bond failed: " << strerror(errno) << ", dropping it\n\r";
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::receive_worker(void* port)
+{
+    port_context* context = reinterpret_cast<port_context*>(port);
+    context->driver->receive(*context);
+}
+
+void
+linux_serial_ccsds_bonded_private_data::receive(port_context& port)
+{
+    const int timeout = static_cast<int>(m_reorder.timeout.count());
+
+    receiving_bond = this;
+    port.decoder.start_decoder();
+    while(port.alive.load()) {
+        struct pollfd descriptor;
+        descriptor.fd = port.fd;
+        descriptor.events = POLLIN;
+        descriptor.revents = 0;
+        const int result = poll(&descriptor, 1, timeout);
+
+        // also when data keeps arriving here, but the missing packet was sent over a failed port
+        expire_missing();
+
+        if(result < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            fail_port(port);
+        } else if(result > 0) {
+            if((descriptor.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+                errno = EIO;
+                fail_port(port);
+                continue;
+            }
+            const ssize_t length = read(port.fd, port.recv_buffer, DRIVER_RECV_BUFFER_SIZE);
+            if(length > 0) {
+                port.decoder.decode_packet(m_bus_id,
+                                           port.recv_buffer,
+                                           static_cast<size_t>(length),
+                                           &linux_serial_ccsds_bonded_private_data::deliver_from_port);
+            } else if(length < 0 && errno != EINTR) {
+                fail_port(port);
+            }
+        }
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::deliver_from_port(enum SystemBus bus_id,
+                                                          uint8_t* const data,
+                                                          const size_t length)
+{
+    (void)bus_id;
+    receiving_bond->reorder_packet(data, length);
+}
+
+void
+linux_serial_ccsds_bonded_private_data::reorder_packet(uint8_t* const data, const size_t length)
+{
+    if(length < SEQUENCE_NUMBER_SIZE) {
+        std::cerr << "Packet without sequence number, dropping it\n\r";
+        return;
+    }
+    const uint32_t sequence = (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16)
+                              | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+    uint8_t* const payload = data + SEQUENCE_NUMBER_SIZE;
+    const size_t payload_length = length - SEQUENCE_NUMBER_SIZE;
+
+    std::lock_guard<std::mutex> lock(m_reorder.mutex);
+
+    if(!m_reorder.synchronized) {
+        m_reorder.expected_sequence = sequence;
+        m_reorder.synchronized = true;
+    }
+
+    const int64_t window = static_cast<int64_t>(m_reorder.window);
+    int64_t distance = static_cast<int32_t>(sequence - m_reorder.expected_sequence);
+    if(distance < 0 || distance > MAX_SEQUENCE_JUMP) {
+        // a single packet arrived after it was given up as lost, or its sequence number is corrupted,
+        // while a run of them means that the remote side restarted its sequence numbers
+        ++m_reorder.out_of_range;
+        if(sequence != 0 && m_reorder.out_of_range <= m_reorder.window) {
+            return;
+        }
+        while(m_reorder.pending != 0) {
+            skip_missing();
+        }
+        m_reorder.expected_sequence = sequence;
+        distance = 0;
+    }
+    m_reorder.out_of_range = 0;
+
+    if(distance >= window) {
+        // no room to wait for the missing packets any longer, held packets older than
+        // the new window are passed on; only the first window sequences can be held
+        const int64_t skipped = distance - window + 1;
+        const int64_t visited = std::min(skipped, window);
+        for(int64_t i = 0; i < visited; ++i) {
+            const size_t slot = (m_reorder.expected_sequence + static_cast<uint32_t>(i)) % m_reorder.window;
+            if(m_reorder.filled[slot]) {
+                Broker_receive_packet(
+                        m_bus_id, &m_reorder.buffers[slot * DECODED_PACKET_BUFFER_SIZE], m_reorder.lengths[slot]);
+                m_reorder.filled[slot] = false;
+                --m_reorder.pending;
+            }
+        }
+        m_reorder.expected_sequence += static_cast<uint32_t>(skipped);
+    }
+    deliver_in_order();
+    distance = static_cast<int32_t>(sequence - m_reorder.expected_sequence);
+
+    if(distance == 0) {
+        // the expected packet is passed to the Broker without copying
+        Broker_receive_packet(m_bus_id, payload, payload_length);
+        ++m_reorder.expected_sequence;
+        deliver_in_order();
+    } else if(distance > 0) {
+        store_packet(sequence, payload, payload_length);
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::store_packet(const uint32_t sequence,
+                                                     const uint8_t* const payload,
+                                                     const size_t length)
+{
+    const size_t slot = sequence % m_reorder.window;
+    if(m_reorder.filled[slot]) {
+        return;
+    }
+    memcpy(&m_reorder.buffers[slot * DECODED_PACKET_BUFFER_SIZE], payload, length);
+    m_reorder.lengths[slot] = length;
+    m_reorder.filled[slot] = true;
+    if(m_reorder.pending == 0) {
+        m_reorder.gap_since = std::chrono::steady_clock::now();
+    }
+    ++m_reorder.pending;
+}
+
+void
+linux_serial_ccsds_bonded_private_data::deliver_in_order()
+{
+    while(m_reorder.pending != 0) {
+        const size_t slot = m_reorder.expected_sequence % m_reorder.window;
+        if(!m_reorder.filled[slot]) {
+            return;
+        }
+        Broker_receive_packet(m_bus_id, &m_reorder.buffers[slot * DECODED_PACKET_BUFFER_SIZE], m_reorder.lengths[slot]);
+        m_reorder.filled[slot] = false;
+        --m_reorder.pending;
+        ++m_reorder.expected_sequence;
+    }
+}
+
+void
+linux_serial_ccsds_bonded_private_data::skip_missing()
+{
+    while(!m_reorder.filled[m_reorder.expected_sequence % m_reorder.window]) {
+        ++m_reorder.expected_sequence;
+    }
+    deliver_in_order();
+}
+
+void
+linux_serial_ccsds_bonded_private_data::expire_missing()
+{
+    std::lock_guard<std::mutex> lock(m_reorder.mutex);
+    if(m_reorder.pending == 0) {
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(now - m_reorder.gap_since >= m_reorder.timeout) {
+        skip_missing();
+        m_reorder.gap_since = now;
+    }
+}
+
+namespace taste {
+
+void
+LinuxSerialCcsdsBondedInit(void* private_data,
+                           const enum SystemBus bus_id,
+                           const enum SystemDevice device_id,
+                           const Serial_CCSDS_Linux_Bond_Conf_T* const device_configuration,
+                           const Serial_CCSDS_Linux_Bond_Conf_T* const remote_device_configuration)
+{
+    linux_serial_ccsds_bonded_private_data* self =
+            reinterpret_cast<linux_serial_ccsds_bonded_private_data*>(private_data);
+    self->driver_init(bus_id, device_id, device_configuration, remote_device_configuration);
+}
+
+void
+LinuxSerialCcsdsBondedSend(void* private_data, const uint8_t* const data, const size_t length)
+{
+    linux_serial_ccsds_bonded_private_data* self =
+            reinterpret_cast<linux_serial_ccsds_bonded_private_data*>(private_data);
+    self->driver_send(data, length);
+}
+
+void
+LinuxSerialCcsdsBondedSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_serial_ccsds_bonded_private_data* self =
+            reinterpret_cast<linux_serial_ccsds_bonded_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
+} // namespace taste
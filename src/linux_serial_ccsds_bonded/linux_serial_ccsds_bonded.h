@@ -0,0 +1,256 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LINUX_SERIAL_CCSDS_BONDED_H
+#define LINUX_SERIAL_CCSDS_BONDED_H
+
+/**
+ * @file     linux_serial_ccsds_bonded.h
+ * @brief    Driver for TASTE which uses several parallel UARTs as one link
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <CacheLine.h>
+#include <FastEscaper.h>
+#include <Fragments.h>
+#include <Thread.h>
+#include <system_spec.h>
+
+#include <drivers_config.h>
+
+extern "C"
+{
+#include <Broker.h>
+}
+
+/**
+ * @brief Structure for driver internal data.
+ *
+ * This structure is allocated by runtime and the pointer is passed to all driver functions.
+ * The name of this structure shall match driver definition from ocarina_components.aadl
+ * and has suffix '_private_data'.
+ *
+ * Every packet is prefixed with a sequence number and sent over one of the ports.
+ * Each port is read by its own thread and received packets are passed to the Broker
+ * in sequence order.
+ */
+class linux_serial_ccsds_bonded_private_data final
+{
+  public:
+    /**
+     * @brief  Constructor.
+     *
+     * Construct empty object, which needs to be initialized using
+     * linux_serial_ccsds_bonded_private_data::driver_init before usage.
+     */
+    linux_serial_ccsds_bonded_private_data();
+
+    /**
+     * @brief  Destructor.
+     *
+     * Destruct created object
+     */
+    ~linux_serial_ccsds_bonded_private_data();
+
+    /**
+     * @brief Initialize driver.
+     *
+     * Opens all ports of the bond and starts their receiving threads.
+     * Ports which cannot be opened are left out of the bond.
+     *
+     * @param bus_id         Identifier of the bus, which is used by driver
+     * @param device_id      Identifier of the device
+     * @param device_configuration Configuration of device
+     * @param remote_device_configuration Configuration of remote device
+     */
+    void driver_init(const SystemBus bus_id,
+                     const SystemDevice device_id,
+                     const Serial_CCSDS_Linux_Bond_Conf_T* const device_configuration,
+                     const Serial_CCSDS_Linux_Bond_Conf_T* const remote_device_configuration);
+
+    /**
+     * @brief Send data to remote partition.
+     *
+     * The packet is sent over the working port with the least data waiting for transmission.
+     * A port which fails is dropped from the bond.
+     *
+     * @param data           The Buffer which data to send to connected remote partition
+     * @param length         The size of the buffer
+     */
+    void driver_send(const uint8_t* data, const size_t length);
+
+    /**
+     * @brief Send data made of fragments to remote partition.
+     *
+     * The sequence number and the fragments are encoded directly, without gathering
+     * them into one buffer first.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+  private:
+    static constexpr int DRIVER_THREAD_PRIORITY = 1;
+    static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
+    static constexpr size_t MAX_PORTS = 4;
+    static constexpr size_t DRIVER_RECV_BUFFER_SIZE = 1 * 1024;
+    static constexpr size_t DECODED_PACKET_BUFFER_SIZE = BROKER_BUFFER_SIZE;
+    // every packet is prefixed with a big endian 32-bit sequence number
+    static constexpr size_t SEQUENCE_NUMBER_SIZE = 4;
+    static constexpr size_t FRAMED_PACKET_BUFFER_SIZE = SEQUENCE_NUMBER_SIZE + DECODED_PACKET_BUFFER_SIZE;
+    // every byte is escaped at most into two, plus start and stop markers
+    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 2 * FRAMED_PACKET_BUFFER_SIZE + 2;
+    static constexpr size_t DEFAULT_REORDER_WINDOW = 16;
+    static constexpr int DEFAULT_REORDER_TIMEOUT = 100;
+    // a larger step forward is taken as a corrupted sequence number until repeated
+    static constexpr int64_t MAX_SEQUENCE_JUMP = 1 << 24;
+    // packets with more fragments are gathered after the sequence number
+    static constexpr size_t MAX_SEND_FRAGMENTS = 16;
+
+    /**
+     * @brief State of one port of the bond.
+     *
+     * The encoder is used under the port's mutex by threads calling driver_send,
+     * the decoder only by the port's receiving thread.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) port_context
+    {
+        linux_serial_ccsds_bonded_private_data* driver;
+        size_t index;
+        int fd;
+        std::atomic<bool> alive;
+        std::unique_ptr<taste::Thread> thread;
+
+        std::mutex mutex;
+        taste::FastEscaper encoder;
+        uint8_t framed_packet_buffer[FRAMED_PACKET_BUFFER_SIZE];
+        uint8_t encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
+
+        alignas(taste::CACHE_LINE_SIZE) taste::FastEscaper decoder;
+        uint8_t recv_buffer[DRIVER_RECV_BUFFER_SIZE];
+        uint8_t decoded_packet_buffer[FRAMED_PACKET_BUFFER_SIZE];
+    };
+
+    /**
+     * @brief Packets received out of order, waiting for the missing ones.
+     *
+     * A packet with sequence number s is kept in slot s % window.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) reorder_context
+    {
+        std::mutex mutex;
+        bool synchronized;
+        uint32_t expected_sequence;
+        size_t window;
+        std::chrono::milliseconds timeout;
+        size_t pending;
+        // number of consecutive packets older than the expected one or too far ahead of it
+        size_t out_of_range;
+        std::chrono::steady_clock::time_point gap_since;
+        std::unique_ptr<uint8_t[]> buffers;
+        std::unique_ptr<size_t[]> lengths;
+        std::unique_ptr<bool[]> filled;
+    };
+
+    void init_reorder(const Serial_CCSDS_Linux_Bond_Conf_T* const device);
+    void init_port(port_context& port, const Serial_CCSDS_Linux_Conf_T* const device);
+    port_context* select_port();
+    void transmit(port_context& port,
+                  const uint32_t sequence,
+                  const struct iovec* const fragments,
+                  const size_t count);
+    bool write_all(port_context& port, const uint8_t* buffer, size_t length);
+    void fail_port(port_context& port);
+
+    static void receive_worker(void* port);
+    void receive(port_context& port);
+    static void deliver_from_port(enum SystemBus bus_id, uint8_t* const data, const size_t length);
+    void reorder_packet(uint8_t* const data, const size_t length);
+    void store_packet(const uint32_t sequence, const uint8_t* payload, const size_t length);
+    void deliver_in_order();
+    void skip_missing();
+    void expire_missing();
+
+    enum SystemBus m_bus_id;
+    enum SystemDevice m_device_id;
+    const Serial_CCSDS_Linux_Bond_Conf_T* m_device_configuration;
+    const Serial_CCSDS_Linux_Bond_Conf_T* m_remote_device_configuration;
+
+    std::mutex m_send_mutex;
+    uint32_t m_next_sequence;
+    size_t m_next_port;
+    size_t m_port_count;
+    port_context m_ports[MAX_PORTS];
+
+    reorder_context m_reorder;
+};
+
+namespace taste {
+
+/**
+ * @brief Initialize driver.
+ *
+ * Function is used by runtime to initialize the driver.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param bus_id         Identifier of the bus, which is used by driver
+ * @param device_id      Identifier of the device
+ * @param device_configuration Configuration of device
+ * @param remote_device_configuration Configuration of remote device
+ */
+void LinuxSerialCcsdsBondedInit(void* private_data,
+                                const SystemBus bus_id,
+                                const SystemDevice device_id,
+                                const Serial_CCSDS_Linux_Bond_Conf_T* const device_configuration,
+                                const Serial_CCSDS_Linux_Bond_Conf_T* const remote_device_configuration);
+
+/**
+ * @brief Send data to remote partition.
+ *
+ * Function is used by runtime.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param data           The Buffer which data to send to connected remote partition
+ * @param length         The size of the buffer
+ */
+void LinuxSerialCcsdsBondedSend(void* private_data, const uint8_t* const data, const size_t length);
+
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxSerialCcsdsBondedSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
+} // namespace taste
+
+#endif
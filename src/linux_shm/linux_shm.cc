@@ -0,0 +1,449 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "linux_shm.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// the control block is used by two processes, so its atomics shall not depend on process-local locks
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics shall be lock free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics shall be lock free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word shall be a plain 32-bit word");
+
+static void
+futex_wait(std::atomic<uint32_t>& word, const uint32_t expected, const struct timespec* const timeout)
+{
+    // the segment is shared between processes, so private futex operations cannot be used
+    if(syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0) != 0
+       && errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+        std::cerr << "futex() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+}
+
+static void
+futex_wake(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+template<typename Ready>
+static void
+wait_until(std::atomic<uint32_t>& sequence, std::atomic<uint32_t>& waiting, Ready ready)
+{
+    while(!ready()) {
+        // the flag is set before the last check, so the other side either sees it or its update is seen here
+        waiting.store(1);
+        const uint32_t observed = sequence.load();
+        if(!ready()) {
+            futex_wait(sequence, observed, nullptr);
+        }
+        waiting.store(0);
+    }
+}
+
+template<typename Ready>
+static bool
+wait_until_deadline(std::atomic<uint32_t>& sequence,
+                    std::atomic<uint32_t>& waiting,
+                    Ready ready,
+                    const std::chrono::steady_clock::time_point deadline)
+{
+    while(!ready()) {
+        const std::chrono::nanoseconds remaining = deadline - std::chrono::steady_clock::now();
+        if(remaining.count() <= 0) {
+            return false;
+        }
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+        timeout.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+
+        waiting.store(1);
+        const uint32_t observed = sequence.load();
+        if(!ready()) {
+            futex_wait(sequence, observed, &timeout);
+        }
+        waiting.store(0);
+    }
+    return true;
+}
+
+static void
+notify(std::atomic<uint32_t>& sequence, std::atomic<uint32_t>& waiting)
+{
+    if(waiting.load() != 0) {
+        sequence.fetch_add(1);
+        futex_wake(sequence);
+    }
+}
+
+linux_shm_private_data::linux_shm_private_data()
+    : m_bus_id()
+    , m_device_id()
+    , m_device_configuration(nullptr)
+    , m_remote_device_configuration(nullptr)
+    , m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_send_ring{ INVALID_FD, 0, nullptr, nullptr, 0 }
+    , m_send_timeout(DEFAULT_SEND_TIMEOUT)
+    , m_next_segment_check()
+    , m_send_stalled(false)
+    , m_stalled_tail(0)
+    , m_receive_ring{ INVALID_FD, 0, nullptr, nullptr, 0 }
+{
+    m_receive_segment[0] = '\0';
+}
+
+linux_shm_private_data::~linux_shm_private_data()
+{
+    unmap_ring(m_send_ring);
+    unmap_ring(m_receive_ring);
+    if(m_receive_segment[0] != '\0') {
+        shm_unlink(m_receive_segment);
+    }
+}
+
+void
+linux_shm_private_data::driver_init(const SystemBus bus_id,
+                                    const SystemDevice device_id,
+                                    const Shared_Memory_Linux_Conf_T* const device_configuration,
+                                    const Shared_Memory_Linux_Conf_T* const remote_device_configuration)
+{
+    m_bus_id = bus_id;
+    m_device_id = device_id;
+    m_device_configuration = device_configuration;
+    m_remote_device_configuration = remote_device_configuration;
+    m_delivery.init(bus_id);
+
+    const size_t ring_size =
+            device_configuration->exist.ring_size ? device_configuration->ring_size : DEFAULT_RING_SIZE;
+    create_receive_ring(ring_size);
+    if(device_configuration->exist.send_timeout) {
+        m_send_timeout = std::chrono::milliseconds(device_configuration->send_timeout);
+    }
+
+    // the remote segment may not exist yet, it is opened by the first send
+    {
+        std::lock_guard<std::mutex> lock(m_send_mutex);
+        open_send_ring();
+    }
+
+    m_thread.start(&taste::LinuxShmPoll, this);
+}
+
+void
+linux_shm_private_data::driver_poll()
+{
+    ring_header* const header = m_receive_ring.header;
+    while(true) {
+        const uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        wait_until(header->data_sequence, header->consumer_waiting, [header, tail] {
+            return header->head.load() != tail;
+        });
+        read_records();
+    }
+}
+
+void
+linux_shm_private_data::driver_send(const uint8_t* const data, const size_t length)
+{
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
+
+void
+linux_shm_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    const size_t length = taste::FragmentsLength(fragments, count);
+    if(length > MAX_PACKET_SIZE) {
+        std::cerr << "Packet too large, dropping it" << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    if(m_send_ring.header != nullptr && send_ring_replaced()) {
+        // the remote partition restarted and nobody reads the old ring anymore
+        unmap_ring(m_send_ring);
+    }
+    if(m_send_ring.header == nullptr && !open_send_ring()) {
+        std::cerr << "Remote shared memory segment is not created yet, dropping packet" << std::endl;
+        return;
+    }
+    if(m_send_stalled) {
+        // a crashed remote partition leaves its segment linked, so only a moving tail shows it reads again
+        if(m_send_ring.header->tail.load() == m_stalled_tail) {
+            std::cerr << "Remote partition does not read the shared memory ring, dropping packet" << std::endl;
+            return;
+        }
+        m_send_stalled = false;
+    }
+    if(!write_record(fragments, count, length)) {
+        std::cerr << "Remote shared memory ring is full, dropping packet" << std::endl;
+        m_send_stalled = true;
+        m_stalled_tail = m_send_ring.header->tail.load();
+    }
+}
+
+void
+linux_shm_private_data::create_receive_ring(const size_t ring_size)
+{
+    const size_t capacity = ring_size / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+    if(capacity < 2 * record_size(MAX_PACKET_SIZE)) {
+        std::cerr << "Shared memory ring is too small for the largest packet" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // a segment left by a previous run may be still mapped by a stale sender, so a new one is created
+    segment_name(m_device_configuration->name, m_receive_segment);
+    shm_unlink(m_receive_segment);
+    m_receive_ring.fd = shm_open(m_receive_segment, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if(m_receive_ring.fd == INVALID_FD) {
+        std::cerr << "shm_open() returned an error: " << strerror(errno) << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const size_t mapping_size = sizeof(ring_header) + capacity;
+    if(ftruncate(m_receive_ring.fd, static_cast<off_t>(mapping_size)) != 0) {
+        std::cerr << "ftruncate() returned an error: " << strerror(errno) << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if(!map_ring(m_receive_ring, mapping_size)) {
+        exit(EXIT_FAILURE);
+    }
+
+    ring_header* const header = new(m_receive_ring.header) ring_header;
+    header->reserved = 0;
+    header->capacity = capacity;
+    header->head.store(0, std::memory_order_relaxed);
+    header->data_sequence.store(0, std::memory_order_relaxed);
+    header->consumer_waiting.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->space_sequence.store(0, std::memory_order_relaxed);
+    header->producer_waiting.store(0, std::memory_order_relaxed);
+    // the sender uses the segment only after it sees the magic number
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+    m_receive_ring.capacity = capacity;
+}
+
+bool
+linux_shm_private_data::open_send_ring()
+{
+    char segment[SEGMENT_NAME_SIZE];
+    segment_name(m_remote_device_configuration->name, segment);
+    m_send_ring.fd = shm_open(segment, O_RDWR, 0);
+    if(m_send_ring.fd == INVALID_FD) {
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(m_send_ring.fd, &status) != 0 || static_cast<size_t>(status.st_size) <= sizeof(ring_header)
+       || !map_ring(m_send_ring, static_cast<size_t>(status.st_size))) {
+        unmap_ring(m_send_ring);
+        return false;
+    }
+
+    ring_header* const header = m_send_ring.header;
+    if(header->magic.load(std::memory_order_acquire) != RING_MAGIC
+       || header->capacity != m_send_ring.mapping_size - sizeof(ring_header)) {
+        // the remote partition is still initializing the segment
+        unmap_ring(m_send_ring);
+        return false;
+    }
+    m_send_ring.capacity = header->capacity;
+    m_next_segment_check = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEGMENT_CHECK_INTERVAL);
+    m_send_stalled = false;
+    return true;
+}
+
+bool
+linux_shm_private_data::send_ring_replaced()
+{
+    // the check is a syscall, so it is done once per interval instead of every send,
+    // unless the ring is stalled, which may mean the remote partition is restarting
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(!m_send_stalled && now < m_next_segment_check) {
+        return false;
+    }
+    m_next_segment_check = now + std::chrono::milliseconds(SEGMENT_CHECK_INTERVAL);
+
+    // a restarted remote partition unlinks the segment and creates a new one under the same name
+    struct stat status;
+    return fstat(m_send_ring.fd, &status) != 0 || status.st_nlink == 0;
+}
+
+size_t
+linux_shm_private_data::record_size(const size_t length)
+{
+    return (RECORD_HEADER_SIZE + length + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+
+bool
+linux_shm_private_data::map_ring(mapped_ring& ring, const size_t mapping_size)
+{
+    void* const mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring.fd, 0);
+    if(mapping == MAP_FAILED) {
+        std::cerr << "mmap() returned an error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    ring.mapping_size = mapping_size;
+    ring.header = static_cast<ring_header*>(mapping);
+    ring.data = static_cast<uint8_t*>(mapping) + sizeof(ring_header);
+    return true;
+}
+
+void
+linux_shm_private_data::unmap_ring(mapped_ring& ring)
+{
+    if(ring.header != nullptr) {
+        munmap(ring.header, ring.mapping_size);
+    }
+    if(ring.fd != INVALID_FD) {
+        close(ring.fd);
+    }
+    ring.fd = INVALID_FD;
+    ring.mapping_size = 0;
+    ring.header = nullptr;
+    ring.data = nullptr;
+    ring.capacity = 0;
+}
+
+void
+linux_shm_private_data::segment_name(const char* const name, char* const segment)
+{
+    segment[0] = '/';
+    strncpy(&segment[1], name, SEGMENT_NAME_SIZE - 2);
+    segment[SEGMENT_NAME_SIZE - 1] = '\0';
+}
+
+bool
+linux_shm_private_data::write_record(const struct iovec* const fragments, const size_t count, const size_t length)
+{
+    ring_header* const header = m_send_ring.header;
+    const size_t capacity = m_send_ring.capacity;
+    const size_t size = record_size(length);
+
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    size_t offset = static_cast<size_t>(head % capacity);
+    // a record is never split, the rest of the ring is skipped instead
+    const size_t skipped = capacity - offset < size ? capacity - offset : 0;
+    const auto space_available = [header, head, capacity, size, skipped] {
+        return capacity - (head - header->tail.load()) >= size + skipped;
+    };
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + m_send_timeout;
+    if(!wait_until_deadline(header->space_sequence, header->producer_waiting, space_available, deadline)) {
+        return false;
+    }
+
+    if(skipped != 0) {
+        const uint32_t wrap = WRAP_RECORD;
+        memcpy(&m_send_ring.data[offset], &wrap, sizeof(wrap));
+        head += skipped;
+        offset = 0;
+    }
+    const uint32_t record_length = static_cast<uint32_t>(length);
+    memcpy(&m_send_ring.data[offset], &record_length, sizeof(record_length));
+    taste::FragmentsGather(fragments, count, &m_send_ring.data[offset + RECORD_HEADER_SIZE]);
+
+    header->head.store(head + size);
+    notify(header->data_sequence, header->consumer_waiting);
+    return true;
+}
+
+void
+linux_shm_private_data::read_records()
+{
+    ring_header* const header = m_receive_ring.header;
+    const size_t capacity = m_receive_ring.capacity;
+    const uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+
+    // packets are passed to the Broker straight from the ring, which is released after delivery
+    m_delivery.begin(m_receive_ring.data, capacity);
+    while(tail != head) {
+        const size_t offset = static_cast<size_t>(tail % capacity);
+        uint32_t length = 0;
+        memcpy(&length, &m_receive_ring.data[offset], sizeof(length));
+        if(length == WRAP_RECORD) {
+            tail += capacity - offset;
+            continue;
+        }
+        if(length > MAX_PACKET_SIZE || record_size(length) > capacity - offset) {
+            std::cerr << "Corrupted shared memory ring" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        m_delivery.add(&m_receive_ring.data[offset + RECORD_HEADER_SIZE], length);
+        tail += record_size(length);
+    }
+    m_delivery.flush();
+
+    header->tail.store(tail);
+    notify(header->space_sequence, header->producer_waiting);
+}
+
+namespace taste {
+
+void
+LinuxShmInit(void* private_data,
+             const enum SystemBus bus_id,
+             const enum SystemDevice device_id,
+             const Shared_Memory_Linux_Conf_T* const device_configuration,
+             const Shared_Memory_Linux_Conf_T* const remote_device_configuration)
+{
+    linux_shm_private_data* self = reinterpret_cast<linux_shm_private_data*>(private_data);
+    self->driver_init(bus_id, device_id, device_configuration, remote_device_configuration);
+}
+
+void
+LinuxShmPoll(void* private_data)
+{
+    linux_shm_private_data* self = reinterpret_cast<linux_shm_private_data*>(private_data);
+    self->driver_poll();
+}
+
+void
+LinuxShmSend(void* private_data, const uint8_t* const data, const size_t length)
+{
+    linux_shm_private_data* self = reinterpret_cast<linux_shm_private_data*>(private_data);
+    self->driver_send(data, length);
+}
+
+void
+LinuxShmSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_shm_private_data* self = reinterpret_cast<linux_shm_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
+} // namespace taste
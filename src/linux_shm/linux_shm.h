@@ -0,0 +1,264 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LINUX_SHM_H
+#define LINUX_SHM_H
+
+/**
+ * @file     linux_shm.h
+ * @brief    Shared memory driver for partitions running on the same host
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <sys/uio.h>
+
+#include <CacheLine.h>
+#include <DeliveryBatch.h>
+#include <Fragments.h>
+#include <Thread.h>
+#include <system_spec.h>
+
+#include <drivers_config.h>
+
+extern "C"
+{
+#include <Broker.h>
+}
+
+/**
+ * @brief Structure for driver internal data.
+ *
+ * This structure is allocated by runtime and the pointer is passed to all driver functions.
+ * The name of this structure shall match driver definition from ocarina_components.aadl
+ * and has suffix '_private_data'.
+ *
+ * Every device receives packets from a ring in its own POSIX shared memory segment,
+ * written only by the remote partition, so the ring has a single producer and a single
+ * consumer. Packets are stored unescaped, each prefixed with its length, and the
+ * waiting side is woken with a futex in the segment.
+ */
+class linux_shm_private_data final
+{
+  public:
+    /**
+     * @brief  Constructor.
+     *
+     * Construct empty object, which needs to be initialized using linux_shm_private_data::init
+     * before usage.
+     */
+    linux_shm_private_data();
+
+    /**
+     * @brief  Destructor.
+     *
+     * Unmap segments and remove the receiving one.
+     */
+    ~linux_shm_private_data();
+
+    /**
+     * @brief Initialize driver.
+     *
+     * Driver needs to be initialized before start. The receiving segment is created anew,
+     * replacing one left by a previous run.
+     *
+     * @param bus_id         Identifier of the bus, which is used by driver
+     * @param device_id      Identifier of the device
+     * @param device_configuration Configuration of device
+     * @param remote_device_configuration Configuration of remote device
+     */
+    void driver_init(const SystemBus bus_id,
+                     const SystemDevice device_id,
+                     const Shared_Memory_Linux_Conf_T* const device_configuration,
+                     const Shared_Memory_Linux_Conf_T* const remote_device_configuration);
+
+    /**
+     * @brief Receive data from remote partition.
+     *
+     * This function waits for packets in the receiving segment and passes them to the Broker
+     * straight from shared memory. If the Broker accepts batches, all packets available
+     * at once are passed together.
+     */
+    void driver_poll();
+
+    /**
+     * @brief Send data to remote partition.
+     *
+     * The packet is copied into the remote partition's ring. The segment is opened by the first
+     * send after the remote partition created it; until then packets are dropped.
+     * When the ring is full, the caller waits for the remote partition to free space,
+     * at most send-timeout, and drops the packet after that. Until the remote partition
+     * frees space again, further packets are dropped without waiting. A segment replaced by
+     * the restarted remote partition is reopened.
+     *
+     * @param data           The Buffer which data to send to connected remote partition
+     * @param length         The size of the buffer
+     */
+    void driver_send(const uint8_t* data, const size_t length);
+
+    /**
+     * @brief Send data made of fragments to remote partition.
+     *
+     * Fragments are copied into the ring one after another.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+  private:
+    static constexpr int DRIVER_THREAD_PRIORITY = 1;
+    static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
+    static constexpr size_t DEFAULT_RING_SIZE = 1048576;
+    static constexpr int DEFAULT_SEND_TIMEOUT = 1000;
+    static constexpr int SEGMENT_CHECK_INTERVAL = 100;
+    static constexpr size_t MAX_PACKET_SIZE = BROKER_BUFFER_SIZE;
+    static constexpr size_t SEGMENT_NAME_SIZE = 48;
+    static constexpr uint32_t RING_MAGIC = 0x54534852;
+    // every record is a 32-bit length followed by the packet, padded to RECORD_ALIGNMENT,
+    // so a record header always fits before the end of the ring
+    static constexpr size_t RECORD_HEADER_SIZE = 8;
+    static constexpr size_t RECORD_ALIGNMENT = 8;
+    // record telling the reader to continue from the beginning of the ring
+    static constexpr uint32_t WRAP_RECORD = 0xFFFFFFFF;
+    static constexpr int INVALID_FD = -1;
+
+    /**
+     * @brief Control block at the start of a segment, shared between two processes.
+     *
+     * Positions grow without wrapping, the ring offset is position % capacity.
+     * Each side waits on its own sequence word when it sets its waiting flag,
+     * and the other side increments the word and wakes it.
+     */
+    struct ring_header
+    {
+        std::atomic<uint32_t> magic;
+        uint32_t reserved;
+        uint64_t capacity;
+
+        alignas(taste::CACHE_LINE_SIZE) std::atomic<uint64_t> head;
+        std::atomic<uint32_t> data_sequence;
+        std::atomic<uint32_t> consumer_waiting;
+
+        alignas(taste::CACHE_LINE_SIZE) std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> space_sequence;
+        std::atomic<uint32_t> producer_waiting;
+    };
+
+    /**
+     * @brief Mapping of a segment.
+     */
+    struct mapped_ring
+    {
+        int fd;
+        size_t mapping_size;
+        ring_header* header;
+        uint8_t* data;
+        size_t capacity;
+    };
+
+    void create_receive_ring(const size_t ring_size);
+    bool open_send_ring();
+    bool send_ring_replaced();
+    static bool map_ring(mapped_ring& ring, const size_t mapping_size);
+    static void unmap_ring(mapped_ring& ring);
+    static void segment_name(const char* const name, char* const segment);
+    static size_t record_size(const size_t length);
+    bool write_record(const struct iovec* const fragments, const size_t count, const size_t length);
+    void read_records();
+
+    enum SystemBus m_bus_id;
+    enum SystemDevice m_device_id;
+    const Shared_Memory_Linux_Conf_T* m_device_configuration;
+    const Shared_Memory_Linux_Conf_T* m_remote_device_configuration;
+    taste::Thread m_thread;
+    char m_receive_segment[SEGMENT_NAME_SIZE];
+
+    // the mutex serializes threads calling driver_send, so the ring has one producer
+    std::mutex m_send_mutex;
+    mapped_ring m_send_ring;
+    std::chrono::milliseconds m_send_timeout;
+    std::chrono::steady_clock::time_point m_next_segment_check;
+    // set after a send timed out; packets are dropped at once until the reader's tail moves
+    bool m_send_stalled;
+    uint64_t m_stalled_tail;
+
+    alignas(taste::CACHE_LINE_SIZE) mapped_ring m_receive_ring;
+    taste::DeliveryBatch m_delivery;
+};
+
+namespace taste {
+
+/**
+ * @brief Initialize driver.
+ *
+ * Function is used by runtime to initialize the driver.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param bus_id         Identifier of the bus, which is used by driver
+ * @param device_id      Identifier of the device
+ * @param device_configuration Configuration of device
+ * @param remote_device_configuration Configuration of remote device
+ */
+void LinuxShmInit(void* private_data,
+                  const SystemBus bus_id,
+                  const SystemDevice device_id,
+                  const Shared_Memory_Linux_Conf_T* const device_configuration,
+                  const Shared_Memory_Linux_Conf_T* const remote_device_configuration);
+
+/**
+ * @brief Function which implements receiving data from remote partition.
+ *
+ * Functions works in separate thread, which is initialized by LinuxShmInit
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ */
+void LinuxShmPoll(void* private_data);
+
+/**
+ * @brief Send data to remote partition.
+ *
+ * Function is used by runtime.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param data           The Buffer which data to send to connected remote partition
+ * @param length         The size of the buffer
+ */
+void LinuxShmSend(void* private_data, const uint8_t* const data, const size_t length);
+
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxShmSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
+} // namespace taste
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "linux_udp.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -32,20 +33,27 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <unistd.h>
 
 linux_udp_private_data::linux_udp_private_data()
-    : m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    : m_send_sockfd(INVALID_SOCKET_ID)
+    , m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_send_queue(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_datagram_framing(false)
+    , m_max_fragment_size(DEFAULT_MAX_DATAGRAM_SIZE - DATAGRAM_HEADER_SIZE)
+    , m_udp_offload(false)
+    , m_udp_segmentation(false)
+    , m_shared_event_loop(false)
+    , m_recv_worker_count(0)
 {
-    Escaper_init(&escaper,
-                 m_encoded_packet_buffer,
-                 ENCODED_PACKET_BUFFER_SIZE,
-                 m_decoded_packet_buffer,
-                 DECODED_PACKET_BUFFER_SIZE);
+    m_encoder.sequence = 0;
+    m_encoder.escaper.init(m_encoder.encoded_packet_buffer, ENCODED_PACKET_BUFFER_SIZE, nullptr, 0);
 }
 
 void
@@ -58,104 +66,628 @@ linux_udp_private_data::driver_init(const SystemBus bus_id,
     m_ip_device_id = device_id;
     m_ip_device_configuration = device_configuration;
     m_ip_remote_device_configuration = remote_device_configuration;
-    m_thread.start(&taste::LinuxUdpPoll, this);
+    m_shared_event_loop = device_configuration->exist.shared_event_loop && device_configuration->shared_event_loop;
+    m_send_sockfd = connect_to_remote_driver();
+    init_framing();
+    init_offload();
+    init_send_queue();
+    init_receive_workers();
+    init_thread_settings();
+
+    if(m_shared_event_loop) {
+        decoder_context& decoder = m_decoders[0];
+        prepare_listen_socket(decoder);
+        // the loop only reads what is already queued, it shall never wait in recvmsg()
+        fcntl(decoder.sockfd, F_SETFL, fcntl(decoder.sockfd, F_GETFL) | O_NONBLOCK);
+        decoder.escaper.start_decoder();
+        taste::EventLoop::shared().add(decoder.sockfd, &linux_udp_private_data::datagram_ready, &decoder);
+    } else {
+        m_thread.start(&taste::LinuxUdpPoll, this);
+    }
 }
 
 void
 linux_udp_private_data::driver_poll()
 {
-    prepare_listen_socket(); // create the socket file descriptor
-
-    // only one active connection
-    const int connected_descriptors_table_size = 1;
-    struct pollfd connected_descriptors_table[connected_descriptors_table_size];
+    for(unsigned int i = 0; i < m_recv_worker_count; ++i) {
+        prepare_listen_socket(m_decoders[i]); // create the socket file descriptor
+    }
 
-    while(true) {
-        Escaper_start_decoder(&escaper);
-        read_data_or_disconnect(connected_descriptors_table);
+    // this thread serves as the first worker
+    for(unsigned int i = 1; i < m_recv_worker_count; ++i) {
+        m_recv_threads.emplace_back(new taste::DriverThread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE));
+        m_recv_threads.back()->configure(m_thread.settings());
+        m_recv_threads.back()->start(&linux_udp_private_data::receive_worker, &m_decoders[i]);
     }
+    receive(m_decoders[0]);
 }
 
 void
 linux_udp_private_data::driver_send(const uint8_t* const data, const size_t length)
 {
-    static int sockfd = INVALID_SOCKET_ID;
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
 
-    if(INVALID_SOCKET_ID == sockfd) {
-        sockfd = connect_to_remote_driver();
-        if (INVALID_SOCKET_ID == sockfd) return;
+void
+linux_udp_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    if(m_send_queue.is_enabled()) {
+        const taste::SendQueuePushResult result = m_send_queue.push(fragments, count);
+        if(result == taste::SendQueuePushResult::Full) {
+            std::cerr << "Send queue is full, dropping packet" << std::endl;
+        } else if(result == taste::SendQueuePushResult::TooLarge) {
+            std::cerr << "Packet larger than send queue slot, dropping it" << std::endl;
+        }
+    } else {
+        transmit(fragments, count);
+    }
+}
+
+taste::SendQueueStatistics
+linux_udp_private_data::driver_send_queue_statistics() const
+{
+    return m_send_queue.statistics();
+}
+
+void
+linux_udp_private_data::transmit_queued(void* private_data, const uint8_t* data, size_t length)
+{
+    linux_udp_private_data* self = reinterpret_cast<linux_udp_private_data*>(private_data);
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    self->transmit(&fragment, 1);
+}
+
+void
+linux_udp_private_data::transmit(const struct iovec* const fragments, const size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_encoder.mutex);
+
+    if(m_send_sockfd == INVALID_SOCKET_ID) {
+        return;
+    }
+
+    const size_t length = taste::FragmentsLength(fragments, count);
+    if(m_datagram_framing) {
+        if(count == 1) {
+            send_fragmented_datagrams(static_cast<const uint8_t*>(fragments[0].iov_base), length);
+            return;
+        }
+        if(length > ENCODED_PACKET_BUFFER_SIZE) {
+            std::cerr << "Packet too large for datagram framing, dropping it" << std::endl;
+            return;
+        }
+        taste::FragmentsGather(fragments, count, m_encoder.encoded_packet_buffer);
+        send_fragmented_datagrams(m_encoder.encoded_packet_buffer, length);
+        return;
     }
-    struct sockaddr_in servaddr;
-    memset(&servaddr, 0, sizeof(servaddr));
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_port = htons(m_ip_remote_device_configuration->port);
-    servaddr.sin_addr.s_addr = inet_addr(m_ip_remote_device_configuration->address);
 
     size_t index = 0;
 
-    Escaper_start_encoder(&escaper);
+    m_encoder.escaper.start_encoder();
     while(index < length) {
-        size_t packet_length = Escaper_encode_packet(&escaper, data, length, &index);
-        sendto(sockfd, m_encoded_packet_buffer, packet_length, MSG_CONFIRM,
-                (const struct sockaddr *) &servaddr, sizeof(servaddr));
+        size_t packet_length = m_encoder.escaper.encode_fragments(fragments, count, &index);
+        if(!send_escaped_datagrams(m_encoder.encoded_packet_buffer, packet_length)) {
+            break;
+        }
+    }
+}
+
+void
+linux_udp_private_data::init_framing()
+{
+    m_datagram_framing = m_ip_device_configuration->exist.udp_framing
+                         && m_ip_device_configuration->udp_framing == Udp_Framing_T_datagram;
+    if(m_ip_device_configuration->exist.max_datagram_size) {
+        m_max_fragment_size = m_ip_device_configuration->max_datagram_size - DATAGRAM_HEADER_SIZE;
+    }
+}
+
+void
+linux_udp_private_data::init_offload()
+{
+    m_udp_offload = m_ip_device_configuration->exist.udp_offload && m_ip_device_configuration->udp_offload;
+    if(!m_udp_offload || !m_datagram_framing || m_send_sockfd == INVALID_SOCKET_ID) {
+        return;
+    }
+
+    // kernels which know the socket option also accept the UDP_SEGMENT control message
+    const int segment_size = 0;
+    if(setsockopt(m_send_sockfd, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size)) == SETSOCKOPT_ERROR) {
+        std::cerr << "UDP_SEGMENT is not supported, falling back to sendmmsg(): " << strerror(errno) << std::endl;
+        return;
+    }
+    m_udp_segmentation = true;
+}
+
+bool
+linux_udp_private_data::send_escaped_datagrams(const uint8_t* buffer, const size_t buffer_length)
+{
+    unsigned int datagram_count = 0;
+    for(size_t offset = 0; offset < buffer_length; offset += UDP_MAX_PAYLOAD_SIZE) {
+        iovec& vector = m_encoder.datagram_vectors[datagram_count];
+        vector.iov_base = const_cast<uint8_t*>(buffer + offset);
+        vector.iov_len = std::min(buffer_length - offset, UDP_MAX_PAYLOAD_SIZE);
+
+        mmsghdr& message = m_encoder.datagram_messages[datagram_count];
+        memset(&message, 0, sizeof(mmsghdr));
+        message.msg_hdr.msg_iov = &vector;
+        message.msg_hdr.msg_iovlen = 1;
+        ++datagram_count;
+    }
+
+    return send_messages(datagram_count);
+}
+
+bool
+linux_udp_private_data::send_fragmented_datagrams(const uint8_t* data, const size_t length)
+{
+    const size_t fragment_count = length == 0 ? 1 : (length + m_max_fragment_size - 1) / m_max_fragment_size;
+    if(fragment_count > MAX_FRAGMENTS_PER_PACKET) {
+        std::cerr << "Packet too large for datagram framing, dropping it" << std::endl;
+        return false;
     }
+    // fragments are of equal size, so the receiver can place them using only the packet length
+    const size_t fragment_size = (length + fragment_count - 1) / fragment_count;
+    const uint16_t sequence = m_encoder.sequence++;
+
+    for(size_t index = 0; index < fragment_count; ++index) {
+        const size_t offset = index * fragment_size;
+
+        uint8_t* const header = m_encoder.datagram_headers[index];
+        header[0] = static_cast<uint8_t>(sequence >> 8);
+        header[1] = static_cast<uint8_t>(sequence);
+        header[2] = static_cast<uint8_t>(index);
+        header[3] = static_cast<uint8_t>(fragment_count);
+        header[4] = static_cast<uint8_t>(length >> 24);
+        header[5] = static_cast<uint8_t>(length >> 16);
+        header[6] = static_cast<uint8_t>(length >> 8);
+        header[7] = static_cast<uint8_t>(length);
+
+        // payload is sent straight from the caller's buffer
+        iovec* const vectors = &m_encoder.datagram_vectors[2 * index];
+        vectors[0].iov_base = header;
+        vectors[0].iov_len = DATAGRAM_HEADER_SIZE;
+        vectors[1].iov_base = const_cast<uint8_t*>(data + offset);
+        vectors[1].iov_len = std::min(fragment_size, length - offset);
+    }
+
+    if(m_udp_segmentation && fragment_count > 1) {
+        if(send_segmented_datagrams(fragment_count, DATAGRAM_HEADER_SIZE + fragment_size)) {
+            return true;
+        }
+        // EIO when the route has no checksum offload, EINVAL when a segment exceeds its MTU
+        if(errno != EIO && errno != EINVAL) {
+            return false;
+        }
+        std::cerr << "UDP_SEGMENT cannot be used on this route, falling back to sendmmsg()" << std::endl;
+        m_udp_segmentation = false;
+    }
+
+    for(size_t index = 0; index < fragment_count; ++index) {
+        mmsghdr& message = m_encoder.datagram_messages[index];
+        memset(&message, 0, sizeof(mmsghdr));
+        message.msg_hdr.msg_iov = &m_encoder.datagram_vectors[2 * index];
+        message.msg_hdr.msg_iovlen = 2;
+    }
+
+    return send_messages(static_cast<unsigned int>(fragment_count));
+}
+
+bool
+linux_udp_private_data::send_segmented_datagrams(const size_t fragment_count, const size_t segment_size)
+{
+    // the kernel splits every message into datagrams of segment_size, header and payload already interleaved
+    const size_t segments_per_message = std::min(UDP_MAX_SEGMENTS, UDP_MAX_PAYLOAD_SIZE / segment_size);
+    const uint16_t gso_size = static_cast<uint16_t>(segment_size);
+
+    unsigned int message_count = 0;
+    for(size_t first = 0; first < fragment_count; first += segments_per_message) {
+        const size_t segments = std::min(segments_per_message, fragment_count - first);
+
+        mmsghdr& message = m_encoder.datagram_messages[message_count];
+        memset(&message, 0, sizeof(mmsghdr));
+        message.msg_hdr.msg_iov = &m_encoder.datagram_vectors[2 * first];
+        message.msg_hdr.msg_iovlen = 2 * segments;
+        message.msg_hdr.msg_control = m_encoder.segment_controls[message_count];
+        message.msg_hdr.msg_controllen = SEGMENT_CONTROL_SIZE;
+
+        cmsghdr* const control = CMSG_FIRSTHDR(&message.msg_hdr);
+        control->cmsg_level = SOL_UDP;
+        control->cmsg_type = UDP_SEGMENT;
+        control->cmsg_len = CMSG_LEN(sizeof(gso_size));
+        memcpy(CMSG_DATA(control), &gso_size, sizeof(gso_size));
+        ++message_count;
+    }
+
+    return send_messages(message_count);
+}
+
+bool
+linux_udp_private_data::send_messages(const unsigned int message_count)
+{
+    unsigned int messages_sent = 0;
+    while(messages_sent < message_count) {
+        const int send_result = sendmmsg(m_send_sockfd,
+                                         &m_encoder.datagram_messages[messages_sent],
+                                         message_count - messages_sent,
+                                         MSG_CONFIRM);
+        if(send_result == SEND_ERROR) {
+            if(errno == EINTR) {
+                continue;
+            }
+            const int send_errno = errno;
+            std::cerr << "sendmmsg() returned an error: " << strerror(send_errno) << std::endl;
+            errno = send_errno;
+            return false;
+        }
+        messages_sent += static_cast<unsigned int>(send_result);
+    }
+    return true;
+}
+
+void
+linux_udp_private_data::init_send_queue()
+{
+    if(!m_ip_device_configuration->exist.send_queue_size || m_ip_device_configuration->send_queue_size == 0) {
+        return;
+    }
+
+    taste::SendQueuePolicy policy = taste::SendQueuePolicy::Block;
+    if(m_ip_device_configuration->exist.send_queue_policy) {
+        switch(m_ip_device_configuration->send_queue_policy) {
+            case Send_Queue_Policy_T_block:
+                policy = taste::SendQueuePolicy::Block;
+                break;
+            case Send_Queue_Policy_T_drop_oldest:
+                policy = taste::SendQueuePolicy::DropOldest;
+                break;
+            case Send_Queue_Policy_T_reject:
+                policy = taste::SendQueuePolicy::Reject;
+                break;
+            default:
+                std::cerr << "Not supported send queue policy, defaulting to block" << std::endl;
+        }
+    }
+
+    m_send_queue.init(m_ip_device_configuration->send_queue_size, policy, DECODED_PACKET_BUFFER_SIZE);
+    m_send_queue.start(&linux_udp_private_data::transmit_queued, this);
 }
 
 int
 linux_udp_private_data::connect_to_remote_driver()
 {
-   const int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(m_ip_remote_device_configuration == nullptr) {
+        return INVALID_SOCKET_ID;
+    }
+
+    const int sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if(sockfd == INVALID_SOCKET_ID) {
+        std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
+        return INVALID_SOCKET_ID;
+    }
 
-   if(sockfd == INVALID_SOCKET_ID) {
-       std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
-       return INVALID_SOCKET_ID;
+    // connected socket has the route and the remote address fixed once, not on every send
+    struct sockaddr_in servaddr;
+    memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_port = htons(static_cast<uint16_t>(m_ip_remote_device_configuration->port));
+    servaddr.sin_addr.s_addr = inet_addr(m_ip_remote_device_configuration->address);
+    if(connect(sockfd, (const struct sockaddr*)&servaddr, sizeof(servaddr)) == CONNECT_ERROR) {
+        std::cerr << "connect() returned an error: " << strerror(errno) << std::endl;
+        close(sockfd);
+        return INVALID_SOCKET_ID;
     }
-   else {
-       return sockfd;
-   }
+
+    return sockfd;
 }
 
 void
-linux_udp_private_data::prepare_listen_socket()
+linux_udp_private_data::receive_worker(void* decoder)
+{
+    decoder_context* context = reinterpret_cast<decoder_context*>(decoder);
+    context->driver->receive(*context);
+}
+
+void
+linux_udp_private_data::receive(decoder_context& decoder)
+{
+    decoder.escaper.start_decoder();
+    while(true) {
+        receive_available(decoder);
+    }
+}
+
+void
+linux_udp_private_data::datagram_ready(void* decoder, uint32_t events)
+{
+    (void)events;
+    decoder_context* context = reinterpret_cast<decoder_context*>(decoder);
+    context->driver->receive_available(*context);
+}
+
+void
+linux_udp_private_data::receive_available(decoder_context& decoder)
+{
+    if(decoder.batch_size != 0) {
+        receive_datagram_batch(decoder);
+    } else {
+        receive_datagram(decoder);
+    }
+}
+
+void
+linux_udp_private_data::prepare_listen_socket(decoder_context& decoder)
 {
     struct sockaddr_in servaddr;
     // Creating UDP socket file descriptor
-    if ((m_listen_sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ) {
+    if ((decoder.sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0 ) {
         std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
     }
+    if(m_recv_worker_count > 1) {
+        const int enable = 1;
+        if(setsockopt(decoder.sockfd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == SETSOCKOPT_ERROR) {
+            std::cerr << "setsockopt() returned an error: " << strerror(errno) << std::endl;
+        }
+    }
     memset(&servaddr, 0, sizeof(servaddr));
     servaddr.sin_family = AF_INET;
     servaddr.sin_addr.s_addr = inet_addr(m_ip_device_configuration->address);
     servaddr.sin_port = htons(m_ip_device_configuration->port);
-    if (bind(m_listen_sockfd, (const struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
+    if (bind(decoder.sockfd, (const struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
         std::cerr << "bind() returned an error: " << strerror(errno) << std::endl;
     }
+    if(m_udp_offload) {
+        const int enable = 1;
+        if(setsockopt(decoder.sockfd, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == SETSOCKOPT_ERROR) {
+            std::cerr << "UDP_GRO is not supported, receiving datagrams one by one: " << strerror(errno) << std::endl;
+        }
+    }
 }
 
 
-bool
-linux_udp_private_data::read_data_or_disconnect(pollfd* table)
+void
+linux_udp_private_data::init_receive_workers()
 {
-    struct sockaddr_in cliaddr;
-    memset(&cliaddr, 0, sizeof(cliaddr));
-    unsigned int len = sizeof(cliaddr);
+    m_recv_worker_count = m_ip_device_configuration->exist.recv_workers
+                                  ? static_cast<unsigned int>(m_ip_device_configuration->recv_workers)
+                                  : DEFAULT_RECV_WORKERS;
+    if(m_shared_event_loop) {
+        // all sockets would be served by the same thread anyway
+        m_recv_worker_count = 1;
+    }
+    m_decoders.reset(new decoder_context[m_recv_worker_count]);
+    m_recv_threads.reserve(m_recv_worker_count - 1);
+
+    for(unsigned int i = 0; i < m_recv_worker_count; ++i) {
+        decoder_context& decoder = m_decoders[i];
+        decoder.driver = this;
+        decoder.sockfd = INVALID_SOCKET_ID;
+        decoder.fragment_sequence = 0;
+        decoder.fragment_count = 0;
+        decoder.fragments_received = 0;
+        decoder.fragmented_packet_length = 0;
+        decoder.escaper.init(nullptr, 0, decoder.decoded_packet_buffer, DECODED_PACKET_BUFFER_SIZE);
+        decoder.delivery.init(m_ip_device_bus_id);
+        init_receive_batch(decoder);
+    }
+}
 
-    const int recv_result = recvfrom(m_listen_sockfd, m_recv_buffer, DRIVER_RECV_BUFFER_SIZE, MSG_WAITALL, (struct sockaddr *) &cliaddr, &len);
+void
+linux_udp_private_data::init_thread_settings()
+{
+    if(!m_ip_device_configuration->exist.recv_thread) {
+        return;
+    }
+
+    taste::ThreadSettings settings = m_thread.settings();
+    taste::ThreadSettingsFromConfig(m_ip_device_configuration->recv_thread, &settings);
+    // recv workers are started later with the same settings
+    m_thread.configure(settings);
+}
+
+void
+linux_udp_private_data::init_receive_batch(decoder_context& decoder)
+{
+    decoder.batch_size = 0;
+    if(!m_ip_device_configuration->exist.recv_batch_size) {
+        return;
+    }
+
+    const unsigned int batch_size = static_cast<unsigned int>(m_ip_device_configuration->recv_batch_size);
+    // datagrams coalesced by UDP_GRO would be truncated by a smaller buffer
+    const size_t buffer_size =
+            m_ip_device_configuration->exist.recv_buffer_size && !m_udp_offload
+                    ? m_ip_device_configuration->recv_buffer_size
+                    : DRIVER_RECV_BUFFER_SIZE;
+
+    decoder.batch_buffers.reset(new uint8_t[batch_size * buffer_size]);
+    decoder.batch_vectors.reset(new iovec[batch_size]);
+    decoder.batch_messages.reset(new mmsghdr[batch_size]);
+    if(m_udp_offload) {
+        decoder.batch_controls.reset(new uint8_t[batch_size * GRO_CONTROL_SIZE]);
+    }
+
+    for(unsigned int i = 0; i < batch_size; ++i) {
+        decoder.batch_vectors[i].iov_base = &decoder.batch_buffers[i * buffer_size];
+        decoder.batch_vectors[i].iov_len = buffer_size;
+        memset(&decoder.batch_messages[i], 0, sizeof(mmsghdr));
+        decoder.batch_messages[i].msg_hdr.msg_iov = &decoder.batch_vectors[i];
+        decoder.batch_messages[i].msg_hdr.msg_iovlen = 1;
+        if(m_udp_offload) {
+            decoder.batch_messages[i].msg_hdr.msg_control = &decoder.batch_controls[i * GRO_CONTROL_SIZE];
+        }
+    }
+
+    decoder.batch_buffer_size = buffer_size;
+    decoder.batch_size = batch_size;
+}
+
+void
+linux_udp_private_data::receive_datagram(decoder_context& decoder)
+{
+    iovec vector;
+    vector.iov_base = decoder.recv_buffer;
+    vector.iov_len = DRIVER_RECV_BUFFER_SIZE;
+
+    msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &vector;
+    header.msg_iovlen = 1;
+    if(m_udp_offload) {
+        header.msg_control = decoder.recv_control;
+        header.msg_controllen = GRO_CONTROL_SIZE;
+    }
+
+    const ssize_t recv_result = recvmsg(decoder.sockfd, &header, MSG_WAITALL);
     if(recv_result == RECV_ERROR) {
-        std::cerr << "recv() returned an error: " << std::strerror(errno) << std::endl;
-        close(table[0].fd);
-        table[0].fd = 0;
-        table[0].events = 0;
-        return false;
-    } else if(recv_result == RECV_CONNECTION_SHUTDOWN) {
-        close(table[0].fd);
-        table[0].fd = 0;
-        table[0].events = 0;
-        return false;
+        if(errno != EAGAIN && errno != EINTR) {
+            std::cerr << "recv() returned an error: " << std::strerror(errno) << std::endl;
+        }
+    } else if((header.msg_flags & MSG_TRUNC) != 0) {
+        std::cerr << "Datagram larger than receive buffer, dropping it" << std::endl;
     } else {
-        const size_t length = static_cast<const size_t>(recv_result);
-        Escaper_decode_packet(&escaper, m_ip_device_bus_id, m_recv_buffer, length, Broker_receive_packet);
-        return true;
+        decoder.delivery.begin(decoder.recv_buffer, static_cast<size_t>(recv_result));
+        split_coalesced_datagrams(decoder, decoder.recv_buffer, static_cast<size_t>(recv_result), &header);
+        decoder.delivery.flush();
+    }
+}
+
+void
+linux_udp_private_data::receive_datagram_batch(decoder_context& decoder)
+{
+    if(m_udp_offload) {
+        // the length of the control buffer is overwritten by every call
+        for(unsigned int i = 0; i < decoder.batch_size; ++i) {
+            decoder.batch_messages[i].msg_hdr.msg_controllen = GRO_CONTROL_SIZE;
+        }
+    }
+
+    // block until at least one datagram arrives, then take all that are already queued
+    const int recv_result =
+            recvmmsg(decoder.sockfd, decoder.batch_messages.get(), decoder.batch_size, MSG_WAITFORONE, nullptr);
+    if(recv_result == RECV_ERROR) {
+        if(errno != EAGAIN && errno != EINTR) {
+            std::cerr << "recvmmsg() returned an error: " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
+
+    const unsigned int received = static_cast<unsigned int>(recv_result);
+    decoder.delivery.begin(decoder.batch_buffers.get(), received * decoder.batch_buffer_size);
+    for(unsigned int i = 0; i < received; ++i) {
+        mmsghdr& message = decoder.batch_messages[i];
+        if((message.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            std::cerr << "Datagram larger than receive buffer, dropping it" << std::endl;
+            continue;
+        }
+        split_coalesced_datagrams(
+                decoder, static_cast<uint8_t*>(message.msg_hdr.msg_iov->iov_base), message.msg_len, &message.msg_hdr);
+    }
+    decoder.delivery.flush();
+}
+
+void
+linux_udp_private_data::split_coalesced_datagrams(decoder_context& decoder,
+                                                  uint8_t* const data,
+                                                  const size_t length,
+                                                  msghdr* const header)
+{
+    size_t segment_size = 0;
+    for(cmsghdr* control = CMSG_FIRSTHDR(header); control != nullptr; control = CMSG_NXTHDR(header, control)) {
+        if(control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+            int gro_size = 0;
+            memcpy(&gro_size, CMSG_DATA(control), sizeof(gro_size));
+            segment_size = gro_size > 0 ? static_cast<size_t>(gro_size) : 0;
+        }
+    }
+
+    if(segment_size == 0 || segment_size >= length) {
+        decode_datagram(decoder, data, length);
+        return;
+    }
+
+    // UDP_GRO coalesces only datagrams of equal size, the last one may be shorter
+    for(size_t offset = 0; offset < length; offset += segment_size) {
+        decode_datagram(decoder, data + offset, std::min(segment_size, length - offset));
+    }
+}
+
+void
+linux_udp_private_data::decode_datagram(decoder_context& decoder, uint8_t* const data, const size_t length)
+{
+    if(m_datagram_framing) {
+        receive_fragment(decoder, data, length);
+        return;
+    }
+
+    // packets larger than a datagram span consecutive datagrams, so the decoder is not restarted;
+    // after a lost datagram it resynchronizes on the start of the next packet
+    decoder.delivery.decode(decoder.escaper, data, length);
+}
+
+void
+linux_udp_private_data::receive_fragment(decoder_context& decoder, uint8_t* const data, const size_t length)
+{
+    if(length < DATAGRAM_HEADER_SIZE) {
+        std::cerr << "Datagram shorter than header, dropping it" << std::endl;
+        return;
+    }
+
+    const uint16_t sequence = static_cast<uint16_t>((data[0] << 8) | data[1]);
+    const size_t index = data[2];
+    const size_t fragment_count = data[3];
+    const size_t packet_length = (static_cast<size_t>(data[4]) << 24) | (static_cast<size_t>(data[5]) << 16)
+                                 | (static_cast<size_t>(data[6]) << 8) | static_cast<size_t>(data[7]);
+    uint8_t* const payload = data + DATAGRAM_HEADER_SIZE;
+    const size_t payload_length = length - DATAGRAM_HEADER_SIZE;
+
+    if(fragment_count == 0 || index >= fragment_count || packet_length > DECODED_PACKET_BUFFER_SIZE) {
+        std::cerr << "Malformed datagram header, dropping it" << std::endl;
+        return;
+    }
+
+    if(fragment_count == 1) {
+        if(payload_length != packet_length) {
+            std::cerr << "Malformed datagram length, dropping it" << std::endl;
+            return;
+        }
+        // whole packet in one datagram is passed to the Broker straight from the receive buffer
+        decoder.delivery.add(payload, packet_length);
+        return;
+    }
+
+    const size_t fragment_size = (packet_length + fragment_count - 1) / fragment_count;
+    const size_t offset = index * fragment_size;
+    if(offset >= packet_length || payload_length != std::min(fragment_size, packet_length - offset)) {
+        std::cerr << "Malformed datagram length, dropping it" << std::endl;
+        return;
+    }
+
+    // a fragment of another packet abandons the incomplete one
+    if(decoder.fragments_received == 0 || sequence != decoder.fragment_sequence
+       || fragment_count != decoder.fragment_count || packet_length != decoder.fragmented_packet_length) {
+        decoder.fragment_sequence = sequence;
+        decoder.fragment_count = fragment_count;
+        decoder.fragmented_packet_length = packet_length;
+        decoder.fragments_received = 0;
+        memset(decoder.fragment_received, 0, sizeof(decoder.fragment_received));
+    }
+
+    if(decoder.fragment_received[index]) {
+        return;
+    }
+    memcpy(&decoder.decoded_packet_buffer[offset], payload, payload_length);
+    decoder.fragment_received[index] = true;
+    ++decoder.fragments_received;
+
+    if(decoder.fragments_received == decoder.fragment_count) {
+        decoder.fragments_received = 0;
+        decoder.delivery.add(decoder.decoded_packet_buffer, packet_length);
     }
 }
 
@@ -175,6 +707,13 @@ LinuxUdpSend(void* private_data, const uint8_t* const data, const size_t length)
     self->driver_send(data, length);
 }
 
+void
+LinuxUdpSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_udp_private_data* self = reinterpret_cast<linux_udp_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
+
 void
 LinuxUdpInit(void* private_data,
                   const enum SystemBus bus_id,
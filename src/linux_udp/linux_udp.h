@@ -32,12 +32,23 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
+#include <netinet/udp.h>
 #include <poll.h>
 
+#include <CacheLine.h>
+#include <DeliveryBatch.h>
+#include <DriverThread.h>
+#include <EventLoop.h>
+#include <FastEscaper.h>
+#include <Fragments.h>
+#include <SendQueue.h>
 #include <Thread.h>
 #include <system_spec.h>
 
@@ -46,7 +57,6 @@
 extern "C"
 {
 #include <Broker.h>
-#include <Escaper.h>
 }
 
 /**
@@ -85,24 +95,78 @@ class linux_udp_private_data final
      * @brief Receive data from remote partitions.
      *
      * This function receives data from remote partition and sends it to the Broker.
+     * If recv-workers is greater than one, additional receiving threads are started, each with
+     * its own SO_REUSEPORT socket. The kernel assigns each flow to one socket, so packets of
+     * a flow are still passed to the Broker in order.
+     * If recv-batch-size is configured, many datagrams are received with one recvmmsg() call.
+     * With udp-offload datagrams coalesced by UDP_GRO are split before decoding.
+     * If the Broker accepts batches, all packets received with one call are passed together.
+     *
+     * It is not used when shared-event-loop is set; a single socket is then served
+     * by taste::EventLoop::shared instead.
      */
     void driver_poll();
     /**
      * @brief send data to remote partition.
      *
+     * With datagram framing the packet is sent without escaping, in one datagram or,
+     * if it exceeds max-datagram-size, in fragments. With udp-offload the fragments are
+     * passed to the kernel as few UDP_SEGMENT buffers, which are split into datagrams there.
+     *
+     * If the send queue is configured, data is only queued and sent later by the driver's
+     * sending thread.
+     *
      * @param data           The Buffer which data to send to connected remote partition
      * @param length         The size of the buffer
      */
     void driver_send(const uint8_t* data, const size_t length);
 
+    /**
+     * @brief send data made of fragments to remote partition.
+     *
+     * Escaped fragments are encoded directly, without gathering them into one buffer first.
+     * With datagram framing they are gathered, because datagrams are cut at fixed offsets.
+     * If the send queue is configured, they are copied into a queue slot instead.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Get counters of the send queue.
+     *
+     * @return Snapshot of the send queue counters
+     */
+    taste::SendQueueStatistics driver_send_queue_statistics() const;
+
   private:
 
     static constexpr int DRIVER_THREAD_PRIORITY = 1;
     static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
     static constexpr int DRIVER_MAX_CONNECTIONS = 1;
-    static constexpr size_t DRIVER_RECV_BUFFER_SIZE = 1 * 1024;
-    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 1 * 1024;
+    static constexpr unsigned int DEFAULT_RECV_WORKERS = 1;
+    static constexpr size_t UDP_MAX_PAYLOAD_SIZE = 65507;
+    static constexpr size_t DRIVER_RECV_BUFFER_SIZE = UDP_MAX_PAYLOAD_SIZE;
     static constexpr size_t DECODED_PACKET_BUFFER_SIZE = BROKER_BUFFER_SIZE;
+    // every byte is escaped at most into two, plus start and stop markers,
+    // so the whole packet is encoded at once
+    static constexpr size_t ENCODED_PACKET_BUFFER_SIZE = 2 * DECODED_PACKET_BUFFER_SIZE + 2;
+    // encoded packet is split into datagrams, which are all sent with one sendmmsg() call
+    static constexpr size_t MAX_ESCAPED_DATAGRAMS_PER_PACKET =
+            (ENCODED_PACKET_BUFFER_SIZE + UDP_MAX_PAYLOAD_SIZE - 1) / UDP_MAX_PAYLOAD_SIZE;
+    // datagram framing header: sequence (16 bits), fragment index (8 bits),
+    // fragment count (8 bits), packet length (32 bits), all big endian
+    static constexpr size_t DATAGRAM_HEADER_SIZE = 8;
+    static constexpr size_t MAX_FRAGMENTS_PER_PACKET = 255;
+    static constexpr size_t DEFAULT_MAX_DATAGRAM_SIZE = 1472;
+    static constexpr size_t MAX_DATAGRAMS_PER_PACKET = MAX_ESCAPED_DATAGRAMS_PER_PACKET > MAX_FRAGMENTS_PER_PACKET
+                                                               ? MAX_ESCAPED_DATAGRAMS_PER_PACKET
+                                                               : MAX_FRAGMENTS_PER_PACKET;
+    // oldest kernels supporting UDP_SEGMENT accept at most 64 segments per send
+    static constexpr size_t UDP_MAX_SEGMENTS = 64;
+    static constexpr size_t SEGMENT_CONTROL_SIZE = CMSG_SPACE(sizeof(uint16_t));
+    static constexpr size_t GRO_CONTROL_SIZE = CMSG_SPACE(sizeof(int));
 
     static constexpr int INVALID_SOCKET_ID = -1;
     static constexpr int POLL_NO_TIMEOUT = -1;
@@ -113,24 +177,101 @@ class linux_udp_private_data final
     static constexpr int CONNECT_ERROR = -1;
     static constexpr int LISTEN_ERROR = -1;
     static constexpr int BIND_ERROR = -1;
+    static constexpr int SETSOCKOPT_ERROR = -1;
+
+    /**
+     * @brief State used to encode sent data.
+     *
+     * The mutex serializes threads calling driver_send, so they never share the encoder.
+     * It is kept on separate cache lines from the state used by the receiving thread.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) encoder_context
+    {
+        std::mutex mutex;
+        taste::FastEscaper escaper;
+        uint8_t encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
+        uint16_t sequence;
+        uint8_t datagram_headers[MAX_FRAGMENTS_PER_PACKET][DATAGRAM_HEADER_SIZE];
+        // header and payload of every datagram
+        iovec datagram_vectors[2 * MAX_DATAGRAMS_PER_PACKET];
+        mmsghdr datagram_messages[MAX_DATAGRAMS_PER_PACKET];
+        alignas(cmsghdr) uint8_t segment_controls[MAX_DATAGRAMS_PER_PACKET][SEGMENT_CONTROL_SIZE];
+    };
+
+    /**
+     * @brief State of one receiving thread.
+     *
+     * Every receiving thread has its own socket and decodes received data independently.
+     * Batch buffers are allocated only if batched receive is configured.
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) decoder_context
+    {
+        linux_udp_private_data* driver;
+        int sockfd;
+        taste::FastEscaper escaper;
+        taste::DeliveryBatch delivery;
+        uint8_t recv_buffer[DRIVER_RECV_BUFFER_SIZE];
+        alignas(cmsghdr) uint8_t recv_control[GRO_CONTROL_SIZE];
+        uint8_t decoded_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
+
+        // reassembly of a fragmented packet with datagram framing
+        uint16_t fragment_sequence;
+        size_t fragment_count;
+        size_t fragments_received;
+        size_t fragmented_packet_length;
+        bool fragment_received[MAX_FRAGMENTS_PER_PACKET];
+
+        unsigned int batch_size;
+        size_t batch_buffer_size;
+        std::unique_ptr<uint8_t[]> batch_buffers;
+        std::unique_ptr<iovec[]> batch_vectors;
+        std::unique_ptr<mmsghdr[]> batch_messages;
+        std::unique_ptr<uint8_t[]> batch_controls;
+    };
 
   private:
+    static void transmit_queued(void* private_data, const uint8_t* data, size_t length);
+    void transmit(const struct iovec* const fragments, const size_t count);
+    void init_send_queue();
     int connect_to_remote_driver();
-    void prepare_listen_socket();
-    bool read_data_or_disconnect(pollfd* table);
+    void init_framing();
+    void init_offload();
+    bool send_escaped_datagrams(const uint8_t* buffer, const size_t buffer_length);
+    bool send_fragmented_datagrams(const uint8_t* data, const size_t length);
+    bool send_segmented_datagrams(const size_t fragment_count, const size_t segment_size);
+    bool send_messages(const unsigned int message_count);
+    static void receive_worker(void* decoder);
+    void receive(decoder_context& decoder);
+    static void datagram_ready(void* decoder, uint32_t events);
+    void receive_available(decoder_context& decoder);
+    void prepare_listen_socket(decoder_context& decoder);
+    void init_receive_workers();
+    void init_thread_settings();
+    void init_receive_batch(decoder_context& decoder);
+    void receive_datagram(decoder_context& decoder);
+    void receive_datagram_batch(decoder_context& decoder);
+    void split_coalesced_datagrams(decoder_context& decoder, uint8_t* data, const size_t length, msghdr* header);
+    void decode_datagram(decoder_context& decoder, uint8_t* data, const size_t length);
+    void receive_fragment(decoder_context& decoder, uint8_t* data, const size_t length);
 
   private:
-    int m_listen_sockfd;
+    int m_send_sockfd;
     enum SystemBus m_ip_device_bus_id;
     enum SystemDevice m_ip_device_id;
     const Socket_IP_Conf_T* m_ip_device_configuration;
     const Socket_IP_Conf_T* m_ip_remote_device_configuration;
-    taste::Thread m_thread;
+    taste::DriverThread m_thread;
+    taste::SendQueue m_send_queue;
+    bool m_datagram_framing;
+    size_t m_max_fragment_size;
+    bool m_udp_offload;
+    bool m_udp_segmentation;
+    bool m_shared_event_loop;
 
-    uint8_t m_recv_buffer[DRIVER_RECV_BUFFER_SIZE];
-    uint8_t m_encoded_packet_buffer[ENCODED_PACKET_BUFFER_SIZE];
-    uint8_t m_decoded_packet_buffer[DECODED_PACKET_BUFFER_SIZE];
-    Escaper escaper;
+    encoder_context m_encoder;
+    unsigned int m_recv_worker_count;
+    std::unique_ptr<decoder_context[]> m_decoders;
+    std::vector<std::unique_ptr<taste::DriverThread>> m_recv_threads;
 };
 
 namespace taste {
@@ -155,6 +296,17 @@ void LinuxUdpPoll(void* private_data);
  */
 void LinuxUdpSend(void* private_data, const uint8_t* const data, const size_t length);
 
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxUdpSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
+
 /**
  * @brief Initialize driver.
  *
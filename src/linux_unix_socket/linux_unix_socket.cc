@@ -0,0 +1,637 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "linux_unix_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <unistd.h>
+
+linux_unix_socket_private_data::linux_unix_socket_private_data()
+    : m_listen_sockfd(INVALID_SOCKET_ID)
+    , m_epollfd(INVALID_SOCKET_ID)
+    , m_send_sockfd(INVALID_SOCKET_ID)
+    , m_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_connection_thread(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_send_queue(DRIVER_THREAD_PRIORITY, DRIVER_THREAD_STACK_SIZE)
+    , m_remote_address_length(0)
+    , m_fd_passing_threshold(0)
+{
+    for(int& sockfd : m_connections) {
+        sockfd = INVALID_SOCKET_ID;
+    }
+
+    // every message of a batch is received into its own buffer
+    for(unsigned int i = 0; i < RECV_BATCH_SIZE; ++i) {
+        m_receiver.vectors[i].iov_base = m_receiver.buffers[i];
+        m_receiver.vectors[i].iov_len = MAX_PACKET_SIZE;
+        memset(&m_receiver.messages[i], 0, sizeof(mmsghdr));
+        m_receiver.messages[i].msg_hdr.msg_iov = &m_receiver.vectors[i];
+        m_receiver.messages[i].msg_hdr.msg_iovlen = 1;
+        m_receiver.messages[i].msg_hdr.msg_control = m_receiver.controls[i];
+    }
+}
+
+void
+linux_unix_socket_private_data::driver_init(const SystemBus bus_id,
+                                            const SystemDevice device_id,
+                                            const Socket_Unix_Conf_T* const device_configuration,
+                                            const Socket_Unix_Conf_T* const remote_device_configuration)
+{
+    m_unix_device_bus_id = bus_id;
+    m_unix_device_id = device_id;
+    m_unix_device_configuration = device_configuration;
+    m_unix_remote_device_configuration = remote_device_configuration;
+    m_delivery.init(bus_id);
+
+    if(m_unix_device_configuration->exist.fd_passing_threshold) {
+        m_fd_passing_threshold = m_unix_device_configuration->fd_passing_threshold;
+    }
+    if(m_unix_remote_device_configuration != nullptr
+       && !fill_address(m_unix_remote_device_configuration->path, &m_remote_address, &m_remote_address_length)) {
+        std::cerr << "Remote socket path is too long." << std::endl;
+    }
+    init_send_queue();
+
+    m_thread.start(&taste::LinuxUnixSocketPoll, this);
+    if(m_unix_device_configuration->exist.reuse_send_socket && m_unix_device_configuration->reuse_send_socket) {
+        m_connection_thread.start(&taste::LinuxUnixSocketManageConnection, this);
+    }
+}
+
+void
+linux_unix_socket_private_data::driver_poll()
+{
+    prepare_listen_socket();
+    prepare_epoll();
+
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+
+    while(true) {
+        // wait for new connections or data without timeout
+        const int epoll_result = epoll_wait(m_epollfd, events, EPOLL_MAX_EVENTS, POLL_NO_TIMEOUT);
+        if(epoll_result == EPOLL_ERROR) {
+            if(errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait() returned an error: " << strerror(errno) << std::endl;
+            std::cerr << "aborting." << std::endl;
+            abort();
+        }
+
+        for(int i = 0; i < epoll_result; ++i) {
+            const uint32_t index = events[i].data.u32;
+            if(index == LISTEN_EVENT_ID) {
+                accept_connection();
+            } else if(m_connections[index] != INVALID_SOCKET_ID) {
+                if(!read_data_or_disconnect(m_connections[index])) {
+                    close_connection(index);
+                }
+            }
+        }
+    }
+}
+
+void
+linux_unix_socket_private_data::driver_send(const uint8_t* const data, const size_t length)
+{
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    driver_send(&fragment, 1);
+}
+
+void
+linux_unix_socket_private_data::driver_send(const struct iovec* const fragments, const size_t count)
+{
+    if(m_send_queue.is_enabled()) {
+        const taste::SendQueuePushResult result = m_send_queue.push(fragments, count);
+        if(result == taste::SendQueuePushResult::Full) {
+            std::cerr << "Send queue is full, dropping packet" << std::endl;
+        } else if(result == taste::SendQueuePushResult::TooLarge) {
+            std::cerr << "Packet larger than send queue slot, dropping it" << std::endl;
+        }
+    } else {
+        transmit(fragments, count);
+    }
+}
+
+taste::SendQueueStatistics
+linux_unix_socket_private_data::driver_send_queue_statistics() const
+{
+    return m_send_queue.statistics();
+}
+
+void
+linux_unix_socket_private_data::driver_manage_connection()
+{
+    int backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(m_send_mutex);
+            m_send_disconnected.wait(lock, [this] { return m_send_sockfd == INVALID_SOCKET_ID; });
+        }
+
+        // connect outside of the lock, senders drop packets in the meantime
+        const int sockfd = connect_to_remote_driver();
+        if(sockfd == INVALID_SOCKET_ID) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+            backoff_ms = std::min(backoff_ms * 2, RECONNECT_BACKOFF_MAX_MS);
+            continue;
+        }
+        backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+
+        std::lock_guard<std::mutex> lock(m_send_mutex);
+        m_send_sockfd = sockfd;
+    }
+}
+
+void
+linux_unix_socket_private_data::transmit_queued(void* private_data, const uint8_t* data, size_t length)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    struct iovec fragment;
+    fragment.iov_base = const_cast<uint8_t*>(data);
+    fragment.iov_len = length;
+    self->transmit(&fragment, 1);
+}
+
+void
+linux_unix_socket_private_data::transmit(const struct iovec* const fragments, const size_t count)
+{
+    const size_t length = taste::FragmentsLength(fragments, count);
+    // an empty message is indistinguishable from a closed connection
+    if(length == 0 || length > MAX_PACKET_SIZE || count > IOV_MAX) {
+        std::cerr << "Packet is empty, too large or too fragmented, dropping it" << std::endl;
+        return;
+    }
+
+    int passed_fd = INVALID_FD;
+    if(m_fd_passing_threshold != 0 && length >= m_fd_passing_threshold) {
+        passed_fd = create_passed_packet(fragments, count, length);
+        if(passed_fd == INVALID_FD) {
+            return;
+        }
+    }
+
+    if(m_unix_device_configuration->exist.reuse_send_socket && m_unix_device_configuration->reuse_send_socket) {
+        transmit_reuse_connection(fragments, count, passed_fd);
+    } else {
+        transmit_new_connection(fragments, count, passed_fd);
+    }
+
+    if(passed_fd != INVALID_FD) {
+        // the remote partition holds its own reference to the memfd
+        close(passed_fd);
+    }
+}
+
+void
+linux_unix_socket_private_data::transmit_new_connection(const struct iovec* const fragments,
+                                                        const size_t count,
+                                                        const int passed_fd)
+{
+    const int sockfd = connect_to_remote_driver();
+    if(sockfd == INVALID_SOCKET_ID) {
+        return;
+    }
+
+    send_message(sockfd, fragments, count, passed_fd);
+    close(sockfd);
+}
+
+void
+linux_unix_socket_private_data::transmit_reuse_connection(const struct iovec* const fragments,
+                                                          const size_t count,
+                                                          const int passed_fd)
+{
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+
+    if(m_send_sockfd == INVALID_SOCKET_ID) {
+        // only the connection manager connects, so the sender never waits for the handshake
+        std::cerr << "Not connected to remote driver, dropping packet" << std::endl;
+        m_send_disconnected.notify_one();
+        return;
+    }
+
+    if(!send_message(m_send_sockfd, fragments, count, passed_fd)) {
+        drop_send_connection();
+    }
+}
+
+int
+linux_unix_socket_private_data::create_passed_packet(const struct iovec* const fragments,
+                                                     const size_t count,
+                                                     const size_t length)
+{
+    const int passed_fd = memfd_create("taste-packet", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if(passed_fd == INVALID_FD) {
+        std::cerr << "memfd_create() returned an error: " << strerror(errno) << std::endl;
+        return INVALID_FD;
+    }
+
+    const ssize_t write_result = writev(passed_fd, fragments, static_cast<int>(count));
+    if(write_result < 0 || static_cast<size_t>(write_result) != length) {
+        std::cerr << "Cannot write packet into memfd, dropping it" << std::endl;
+        close(passed_fd);
+        return INVALID_FD;
+    }
+
+    // the remote partition maps the packet, so its size and contents shall not change afterwards
+    const int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+    if(fcntl(passed_fd, F_ADD_SEALS, seals) != 0) {
+        std::cerr << "Cannot seal memfd: " << strerror(errno) << std::endl;
+        close(passed_fd);
+        return INVALID_FD;
+    }
+    return passed_fd;
+}
+
+bool
+linux_unix_socket_private_data::send_message(const int sockfd,
+                                             const struct iovec* const fragments,
+                                             const size_t count,
+                                             const int passed_fd)
+{
+    msghdr header;
+    memset(&header, 0, sizeof(header));
+
+    uint8_t marker = PASSED_FD_MARKER;
+    struct iovec marker_vector;
+    alignas(struct cmsghdr) uint8_t control[PASSED_FD_CONTROL_SIZE];
+
+    if(passed_fd == INVALID_FD) {
+        header.msg_iov = const_cast<struct iovec*>(fragments);
+        header.msg_iovlen = count;
+    } else {
+        marker_vector.iov_base = &marker;
+        marker_vector.iov_len = sizeof(marker);
+        header.msg_iov = &marker_vector;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+
+        cmsghdr* const rights = CMSG_FIRSTHDR(&header);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(rights), &passed_fd, sizeof(int));
+    }
+
+    // the whole packet is sent as one message, or not at all
+    while(sendmsg(sockfd, &header, MSG_NOSIGNAL) == SEND_ERROR) {
+        if(errno != EINTR) {
+            std::cerr << "sendmsg() returned an error: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+linux_unix_socket_private_data::drop_send_connection()
+{
+    // called with m_send_mutex locked
+    close(m_send_sockfd);
+    m_send_sockfd = INVALID_SOCKET_ID;
+    m_send_disconnected.notify_one();
+}
+
+void
+linux_unix_socket_private_data::init_send_queue()
+{
+    if(!m_unix_device_configuration->exist.send_queue_size || m_unix_device_configuration->send_queue_size == 0) {
+        return;
+    }
+
+    taste::SendQueuePolicy policy = taste::SendQueuePolicy::Block;
+    if(m_unix_device_configuration->exist.send_queue_policy) {
+        switch(m_unix_device_configuration->send_queue_policy) {
+            case Socket_Unix_Send_Queue_Policy_T_block:
+                policy = taste::SendQueuePolicy::Block;
+                break;
+            case Socket_Unix_Send_Queue_Policy_T_drop_oldest:
+                policy = taste::SendQueuePolicy::DropOldest;
+                break;
+            case Socket_Unix_Send_Queue_Policy_T_reject:
+                policy = taste::SendQueuePolicy::Reject;
+                break;
+            default:
+                std::cerr << "Not supported send queue policy, defaulting to block" << std::endl;
+        }
+    }
+
+    m_send_queue.init(m_unix_device_configuration->send_queue_size, policy, MAX_PACKET_SIZE);
+    m_send_queue.start(&linux_unix_socket_private_data::transmit_queued, this);
+}
+
+bool
+linux_unix_socket_private_data::fill_address(const char* path, sockaddr_un* address, socklen_t* address_length)
+{
+    const size_t path_length = strlen(path);
+    if(path_length >= sizeof(address->sun_path)) {
+        return false;
+    }
+
+    memset(address, 0, sizeof(sockaddr_un));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, path, path_length);
+    if(path[0] == '@') {
+        // abstract socket names are not terminated, their length is given by the address length
+        address->sun_path[0] = '\0';
+        *address_length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path_length);
+    } else {
+        *address_length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path_length + 1);
+    }
+    return true;
+}
+
+int
+linux_unix_socket_private_data::connect_to_remote_driver()
+{
+    if(m_remote_address_length == 0) {
+        std::cerr << "Remote address is not set." << std::endl;
+        return INVALID_SOCKET_ID;
+    }
+
+    const int sockfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if(sockfd == INVALID_SOCKET_ID) {
+        std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
+        return INVALID_SOCKET_ID;
+    }
+    const int connect_result =
+            connect(sockfd, reinterpret_cast<const sockaddr*>(&m_remote_address), m_remote_address_length);
+    if(connect_result == CONNECT_ERROR) {
+        std::cerr << "connect() returned an error: " << strerror(errno) << std::endl;
+        close(sockfd);
+        return INVALID_SOCKET_ID;
+    }
+
+    return sockfd;
+}
+
+void
+linux_unix_socket_private_data::prepare_listen_socket()
+{
+    sockaddr_un address;
+    socklen_t address_length = 0;
+    if(!fill_address(m_unix_device_configuration->path, &address, &address_length)) {
+        std::cerr << "Socket path is too long\n";
+        abort();
+    }
+
+    m_listen_sockfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(m_listen_sockfd == INVALID_SOCKET_ID) {
+        std::cerr << "socket() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+
+    // a socket file left by a previous run would make bind fail
+    if(address.sun_path[0] != '\0') {
+        unlink(address.sun_path);
+    }
+    const int bind_result = bind(m_listen_sockfd, reinterpret_cast<const sockaddr*>(&address), address_length);
+    if(bind_result == BIND_ERROR) {
+        std::cerr << "bind() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+
+    const int listen_result = listen(m_listen_sockfd, DRIVER_MAX_CONNECTIONS);
+    if(listen_result == LISTEN_ERROR) {
+        std::cerr << "Cannot listen on socket\n";
+        abort();
+    }
+}
+
+void
+linux_unix_socket_private_data::prepare_epoll()
+{
+    m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(m_epollfd == INVALID_SOCKET_ID) {
+        std::cerr << "epoll_create1() returned an error: " << strerror(errno) << std::endl;
+        abort();
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = LISTEN_EVENT_ID;
+    if(epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_listen_sockfd, &event) == EPOLL_ERROR) {
+        std::cerr << "Cannot watch listen socket: " << strerror(errno) << std::endl;
+        abort();
+    }
+}
+
+void
+linux_unix_socket_private_data::accept_connection()
+{
+    // accepted sockets are non-blocking, so a stale event can never stall the loop
+    const int new_sockfd = accept4(m_listen_sockfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(new_sockfd == INVALID_SOCKET_ID) {
+        if(errno != EAGAIN) {
+            std::cerr << "accept() returned an error: " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
+
+    uint32_t index = 0;
+    while(index < DRIVER_MAX_CONNECTIONS && m_connections[index] != INVALID_SOCKET_ID) {
+        ++index;
+    }
+    if(index == DRIVER_MAX_CONNECTIONS) {
+        std::cerr << "Too many connections, rejecting new one" << std::endl;
+        close(new_sockfd);
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u32 = index;
+    if(epoll_ctl(m_epollfd, EPOLL_CTL_ADD, new_sockfd, &event) == EPOLL_ERROR) {
+        std::cerr << "Cannot watch accepted socket: " << strerror(errno) << std::endl;
+        close(new_sockfd);
+        return;
+    }
+
+    m_connections[index] = new_sockfd;
+}
+
+void
+linux_unix_socket_private_data::close_connection(const uint32_t index)
+{
+    // closing the descriptor removes it from the epoll set
+    close(m_connections[index]);
+    m_connections[index] = INVALID_SOCKET_ID;
+}
+
+bool
+linux_unix_socket_private_data::read_data_or_disconnect(const int sockfd)
+{
+    // the length of the control buffer is overwritten by every call
+    for(unsigned int i = 0; i < RECV_BATCH_SIZE; ++i) {
+        m_receiver.messages[i].msg_hdr.msg_controllen = PASSED_FD_CONTROL_SIZE;
+    }
+
+    const int recv_result =
+            recvmmsg(sockfd, m_receiver.messages, RECV_BATCH_SIZE, MSG_DONTWAIT | MSG_CMSG_CLOEXEC, nullptr);
+    if(recv_result == RECV_ERROR) {
+        if(errno == EAGAIN || errno == EINTR) {
+            return true;
+        }
+        std::cerr << "recvmmsg() returned an error: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool connected = true;
+    const unsigned int received = static_cast<unsigned int>(recv_result);
+    m_delivery.begin(&m_receiver.buffers[0][0], sizeof(m_receiver.buffers));
+    for(unsigned int i = 0; i < received; ++i) {
+        mmsghdr& message = m_receiver.messages[i];
+        const int passed_fd = take_passed_fd(&message.msg_hdr);
+        if(passed_fd != INVALID_FD) {
+            deliver_passed_packet(passed_fd);
+            close(passed_fd);
+        } else if(message.msg_len == 0) {
+            // empty packets are never sent, so this is the end of the connection
+            connected = false;
+            break;
+        } else if((message.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            std::cerr << "Packet larger than receive buffer, dropping it" << std::endl;
+        } else {
+            m_delivery.add(m_receiver.buffers[i], message.msg_len);
+        }
+    }
+    m_delivery.flush();
+    return connected;
+}
+
+int
+linux_unix_socket_private_data::take_passed_fd(msghdr* const header)
+{
+    int passed_fd = INVALID_FD;
+    for(cmsghdr* control = CMSG_FIRSTHDR(header); control != nullptr; control = CMSG_NXTHDR(header, control)) {
+        if(control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const size_t count = (control->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for(size_t i = 0; i < count; ++i) {
+            int fd = INVALID_FD;
+            memcpy(&fd, CMSG_DATA(control) + i * sizeof(int), sizeof(int));
+            // only one descriptor is expected, any other would leak
+            if(passed_fd == INVALID_FD) {
+                passed_fd = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+    return passed_fd;
+}
+
+void
+linux_unix_socket_private_data::deliver_passed_packet(const int passed_fd)
+{
+    // a memfd which can still shrink could make reading the mapping raise SIGBUS
+    const int seals = fcntl(passed_fd, F_GET_SEALS);
+    if(seals == -1 || (seals & F_SEAL_SHRINK) == 0) {
+        std::cerr << "Passed packet is not sealed, dropping it" << std::endl;
+        return;
+    }
+
+    struct stat status;
+    if(fstat(passed_fd, &status) != 0 || status.st_size <= 0
+       || static_cast<size_t>(status.st_size) > MAX_PACKET_SIZE) {
+        std::cerr << "Passed packet is empty or too large, dropping it" << std::endl;
+        return;
+    }
+
+    // the Broker takes a writable buffer, a private mapping keeps its writes local
+    const size_t length = static_cast<size_t>(status.st_size);
+    void* const mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, passed_fd, 0);
+    if(mapping == MAP_FAILED) {
+        std::cerr << "mmap() returned an error: " << strerror(errno) << std::endl;
+        return;
+    }
+    // the packet is outside of the receive buffers, so a batch keeps its own copy
+    m_delivery.add(static_cast<uint8_t*>(mapping), length);
+    munmap(mapping, length);
+}
+
+namespace taste {
+
+void
+LinuxUnixSocketPoll(void* private_data)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    self->driver_poll();
+}
+
+void
+LinuxUnixSocketManageConnection(void* private_data)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    self->driver_manage_connection();
+}
+
+void
+LinuxUnixSocketSend(void* private_data, const uint8_t* const data, const size_t length)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    self->driver_send(data, length);
+}
+
+void
+LinuxUnixSocketSendFragments(void* private_data, const struct iovec* const fragments, const size_t count)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    self->driver_send(fragments, count);
+}
+
+void
+LinuxUnixSocketInit(void* private_data,
+                    const enum SystemBus bus_id,
+                    const enum SystemDevice device_id,
+                    const Socket_Unix_Conf_T* const device_configuration,
+                    const Socket_Unix_Conf_T* const remote_device_configuration)
+{
+    linux_unix_socket_private_data* self = reinterpret_cast<linux_unix_socket_private_data*>(private_data);
+    self->driver_init(bus_id, device_id, device_configuration, remote_device_configuration);
+}
+} // namespace taste
@@ -0,0 +1,276 @@
+/**@file
+ * This file is part of the TASTE Linux Runtime.
+ *
+ * @copyright 2021 N7 Space Sp. z o.o.
+ *
+ * TASTE Linux Runtime was developed under a programme of,
+ * and funded by, the European Space Agency (the "ESA").
+ *
+ * Licensed under the ESA Public License (ESA-PL) Permissive,
+ * Version 2.3 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://essr.esa.int/license/list
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LINUX_UNIX_SOCKET_H
+#define LINUX_UNIX_SOCKET_H
+
+/**
+ * @file     linux_unix_socket.h
+ * @brief    Driver for TASTE which uses Unix domain sequenced-packet sockets for communication.
+ *
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <CacheLine.h>
+#include <DeliveryBatch.h>
+#include <Fragments.h>
+#include <SendQueue.h>
+#include <Thread.h>
+#include <system_spec.h>
+
+#include <drivers_config.h>
+
+extern "C"
+{
+#include <Broker.h>
+}
+
+/**
+ * @brief Structure for driver internal data.
+ *
+ * This structure is allocated by runtime and the pointer is passed to all driver functions.
+ * The name of this structure shall match driver definition from ocarina_components.aadl
+ * and has suffix '_private_data'.
+ *
+ * SOCK_SEQPACKET keeps message boundaries, so every packet is sent as one message
+ * without escaping, and received with no decoding.
+ */
+class linux_unix_socket_private_data final
+{
+  public:
+    /**
+     * @brief  Constructor.
+     *
+     * Construct empty object, which needs to be initialized using linux_unix_socket_private_data::init
+     * before usage.
+     */
+    linux_unix_socket_private_data();
+
+    /**
+     * @brief Initialize driver.
+     *
+     * Driver needs to be initialized before start.
+     *
+     * @param bus_id         Identifier of the bus, which is used by driver
+     * @param device_id      Identifier of the device
+     * @param device_configuration Configuration of device
+     * @param remote_device_configuration Configuration of remote device
+     */
+    void driver_init(const SystemBus bus_id,
+                     const SystemDevice device_id,
+                     const Socket_Unix_Conf_T* const device_configuration,
+                     const Socket_Unix_Conf_T* const remote_device_configuration);
+    /**
+     * @brief Receive data from remote partitions.
+     *
+     * This function receives packets from remote partitions and sends them to the Broker.
+     * All connections are served by a single epoll loop. Packets already queued on a connection
+     * are received with one recvmmsg() and, if the Broker accepts batches, passed together.
+     */
+    void driver_poll();
+    /**
+     * @brief send data to remote partition.
+     *
+     * If the send queue is configured, data is only queued and sent later by the driver's
+     * sending thread.
+     *
+     * @param data           The Buffer which data to send to connected remote partition
+     * @param length         The size of the buffer
+     */
+    void driver_send(const uint8_t* data, const size_t length);
+
+    /**
+     * @brief send data made of fragments to remote partition.
+     *
+     * Fragments are passed to sendmsg() as they are, so the packet is never gathered.
+     * If the send queue is configured, they are copied into a queue slot instead.
+     *
+     * @param fragments      Fragments of the packet, in order
+     * @param count          Number of fragments
+     */
+    void driver_send(const struct iovec* const fragments, const size_t count);
+
+    /**
+     * @brief Get counters of the send queue.
+     *
+     * @return Snapshot of the send queue counters
+     */
+    taste::SendQueueStatistics driver_send_queue_statistics() const;
+
+    /**
+     * @brief Keep the connection to remote partition up.
+     *
+     * This function works in a separate thread and reconnects with bounded exponential
+     * backoff whenever the connection used to send data is lost.
+     */
+    void driver_manage_connection();
+
+  private:
+    static constexpr int DRIVER_THREAD_PRIORITY = 1;
+    static constexpr int DRIVER_THREAD_STACK_SIZE = 65536;
+    static constexpr int DRIVER_MAX_CONNECTIONS = 16;
+    static constexpr int EPOLL_MAX_EVENTS = DRIVER_MAX_CONNECTIONS + 1;
+    static constexpr uint32_t LISTEN_EVENT_ID = DRIVER_MAX_CONNECTIONS;
+    static constexpr size_t MAX_PACKET_SIZE = BROKER_BUFFER_SIZE;
+    static constexpr unsigned int RECV_BATCH_SIZE = 16;
+    // room for one passed descriptor, others are closed by the kernel
+    static constexpr size_t PASSED_FD_CONTROL_SIZE = CMSG_SPACE(sizeof(int));
+    // body of the message which carries a passed descriptor
+    static constexpr uint8_t PASSED_FD_MARKER = 0;
+
+    static constexpr int INVALID_SOCKET_ID = -1;
+    static constexpr int INVALID_FD = -1;
+    static constexpr int POLL_NO_TIMEOUT = -1;
+    static constexpr int EPOLL_ERROR = -1;
+    static constexpr int SEND_ERROR = -1;
+    static constexpr int RECV_ERROR = -1;
+    static constexpr int CONNECT_ERROR = -1;
+    static constexpr int LISTEN_ERROR = -1;
+    static constexpr int BIND_ERROR = -1;
+
+    static constexpr int RECONNECT_BACKOFF_MIN_MS = 10;
+    static constexpr int RECONNECT_BACKOFF_MAX_MS = 1000;
+
+    /**
+     * @brief Buffers for messages received with one recvmmsg().
+     */
+    struct alignas(taste::CACHE_LINE_SIZE) receiver_context
+    {
+        uint8_t buffers[RECV_BATCH_SIZE][MAX_PACKET_SIZE];
+        struct iovec vectors[RECV_BATCH_SIZE];
+        struct mmsghdr messages[RECV_BATCH_SIZE];
+        alignas(struct cmsghdr) uint8_t controls[RECV_BATCH_SIZE][PASSED_FD_CONTROL_SIZE];
+    };
+
+  private:
+    static void transmit_queued(void* private_data, const uint8_t* data, size_t length);
+    void transmit(const struct iovec* const fragments, const size_t count);
+    void transmit_new_connection(const struct iovec* const fragments, const size_t count, const int passed_fd);
+    void transmit_reuse_connection(const struct iovec* const fragments, const size_t count, const int passed_fd);
+    int create_passed_packet(const struct iovec* const fragments, const size_t count, const size_t length);
+    bool send_message(const int sockfd, const struct iovec* const fragments, const size_t count, const int passed_fd);
+    void init_send_queue();
+    static bool fill_address(const char* path, sockaddr_un* address, socklen_t* address_length);
+    int connect_to_remote_driver();
+    void drop_send_connection();
+    void prepare_listen_socket();
+    void prepare_epoll();
+    void accept_connection();
+    void close_connection(const uint32_t index);
+    bool read_data_or_disconnect(const int sockfd);
+    static int take_passed_fd(msghdr* const header);
+    void deliver_passed_packet(const int passed_fd);
+
+  private:
+    int m_listen_sockfd;
+    int m_epollfd;
+    int m_send_sockfd;
+    enum SystemBus m_unix_device_bus_id;
+    enum SystemDevice m_unix_device_id;
+    const Socket_Unix_Conf_T* m_unix_device_configuration;
+    const Socket_Unix_Conf_T* m_unix_remote_device_configuration;
+    taste::Thread m_thread;
+    taste::Thread m_connection_thread;
+    taste::SendQueue m_send_queue;
+
+    sockaddr_un m_remote_address;
+    socklen_t m_remote_address_length;
+    size_t m_fd_passing_threshold;
+
+    std::mutex m_send_mutex;
+    std::condition_variable m_send_disconnected;
+
+    int m_connections[DRIVER_MAX_CONNECTIONS];
+    receiver_context m_receiver;
+    taste::DeliveryBatch m_delivery;
+};
+
+namespace taste {
+
+/**
+ * @brief Function which implements receiving data from remote partition.
+ *
+ * Functions works in separate thread, which is initialized by LinuxUnixSocketInit
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ */
+void LinuxUnixSocketPoll(void* private_data);
+
+/**
+ * @brief Function which keeps the connection to remote partition up.
+ *
+ * Functions works in separate thread, which is started by LinuxUnixSocketInit
+ * when the send socket is reused.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ */
+void LinuxUnixSocketManageConnection(void* private_data);
+
+/**
+ * @brief Send data to remote partition.
+ *
+ * Function is used by runtime.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param data           The Buffer which data to send to connected remote partition
+ * @param length         The size of the buffer
+ */
+void LinuxUnixSocketSend(void* private_data, const uint8_t* const data, const size_t length);
+
+/**
+ * @brief Send data made of fragments to remote partition.
+ *
+ * Function is used by callers which would otherwise copy fragments into one buffer.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param fragments      Fragments of the packet, in order
+ * @param count          Number of fragments
+ */
+void LinuxUnixSocketSendFragments(void* private_data, const struct iovec* const fragments, const size_t count);
+
+/**
+ * @brief Initialize driver.
+ *
+ * Function is used by runtime to initialize the driver.
+ *
+ * @param private_data   Driver private data, allocated by runtime
+ * @param bus_id         Identifier of the bus, which is used by driver
+ * @param device_id      Identifier of the device
+ * @param device_configuration Configuration of device
+ * @param remote_device_configuration Configuration of remote device
+ */
+void LinuxUnixSocketInit(void* private_data,
+                         const SystemBus bus_id,
+                         const SystemDevice device_id,
+                         const Socket_Unix_Conf_T* const device_configuration,
+                         const Socket_Unix_Conf_T* const remote_device_configuration);
+} // namespace taste
+
+#endif